@@ -0,0 +1,67 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "buffers/arena.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+// free ranges bookkeeping only, there is no memory behind the arena
+class BenchmarkArena : public cyclonite::buffers::Arena<BenchmarkArena>
+{
+public:
+    explicit BenchmarkArena(size_t size)
+      : Arena<BenchmarkArena>{ size }
+    {
+    }
+
+    [[nodiscard]] auto ptr() const -> void const* { return nullptr; }
+
+    auto ptr() -> void* { return nullptr; }
+};
+
+static constexpr auto _maxAllocationSize = size_t{ 1024 };
+
+static auto _allocationSize(std::minstd_rand& random) -> size_t
+{
+    return (1 + random() % (_maxAllocationSize / 16)) * 16;
+}
+
+// every other allocation is freed first, so the free list is as long as the number of the live allocations,
+// then the oldest allocation is replaced by a new one of a random size
+static void arenaAllocFreeFragmented(benchmark::State& state)
+{
+    auto const liveCount = static_cast<size_t>(state.range(0));
+
+    auto random = std::minstd_rand{ 42 };
+    auto arena = BenchmarkArena{ 4 * liveCount * _maxAllocationSize };
+    auto allocations = std::vector<BenchmarkArena::AllocatedMemory>{};
+
+    allocations.reserve(liveCount * 2);
+
+    for (auto i = size_t{ 0 }; i < liveCount * 2; i++)
+        allocations.push_back(arena.alloc(_allocationSize(random)));
+
+    for (auto i = size_t{ 1 }; i < allocations.size(); i += 2) {
+        arena.free(allocations[i]);
+        allocations[i] = BenchmarkArena::AllocatedMemory{};
+    }
+
+    std::erase_if(allocations, [](auto const& allocation) -> bool { return allocation.size() == 0; });
+
+    auto cursor = size_t{ 0 };
+
+    for (auto _ : state) {
+        auto& allocation = allocations[cursor];
+
+        arena.free(allocation);
+        allocation = arena.alloc(_allocationSize(random));
+
+        cursor = (cursor + 1) % liveCount;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(arenaAllocFreeFragmented)->Arg(64)->Arg(1024);
@@ -0,0 +1,164 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "multithreading/lockFreeQueue.h"
+#include "multithreading/taskManager.h"
+#include "multithreading/taskPool.h"
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace cyclonite::multithreading;
+
+static void lockFreeQueuePushPop(benchmark::State& state)
+{
+    auto const batchSize = static_cast<uint64_t>(state.range(0));
+    auto queue = lock_free_spmc_queue_t<uint64_t>{ 1024 };
+
+    for (auto _ : state) {
+        for (auto i = uint64_t{ 0 }; i < batchSize; i++)
+            queue.emplaceBottom(i);
+
+        for (auto i = uint64_t{ 0 }; i < batchSize; i++)
+            benchmark::DoNotOptimize(queue.popBottom());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(batchSize));
+}
+
+BENCHMARK(lockFreeQueuePushPop)->Arg(64)->Arg(4096);
+
+// the owner pushes and pops a batch while thieves try to take it away
+static void lockFreeQueueStealUnderContention(benchmark::State& state)
+{
+    auto const batchSize = uint64_t{ 16 };
+
+    auto queue = lock_free_spmc_queue_t<uint64_t>{ 1024 };
+    auto stolenCount = std::atomic<uint64_t>{ 0 };
+    auto stop = std::atomic<bool>{ false };
+
+    auto thieves = std::vector<std::thread>{};
+
+    for (auto i = int64_t{ 0 }; i < state.range(0); i++) {
+        thieves.emplace_back([&]() -> void {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (queue.steal())
+                    stolenCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto _ : state) {
+        for (auto i = uint64_t{ 0 }; i < batchSize; i++)
+            queue.emplaceBottom(i);
+
+        while (queue.popBottom()) {
+        }
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+
+    for (auto&& thief : thieves)
+        thief.join();
+
+    auto const itemCount = state.iterations() * static_cast<int64_t>(batchSize);
+
+    state.SetItemsProcessed(itemCount);
+    state.counters["stolen"] = static_cast<double>(stolenCount.load()) / static_cast<double>(itemCount);
+}
+
+BENCHMARK(lockFreeQueueStealUnderContention)->Arg(1)->Arg(3)->UseRealTime();
+
+// a whole life of a pooled task, from acquisition to release
+static void taskPoolAcquireRelease(benchmark::State& state)
+{
+    auto pool = TaskPool{ 1024 };
+    auto tasks = std::vector<Task*>(static_cast<size_t>(state.range(0)));
+    auto sequence = uint64_t{ 0 };
+
+    for (auto _ : state) {
+        for (auto&& task : tasks) {
+            task = pool.writeableTask();
+            task->emplace([]() -> void {}, ++sequence, TaskPriority::NORMAL);
+        }
+
+        for (auto* task : tasks) {
+            (*task)();
+            TaskPool::release(task);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(taskPoolAcquireRelease)->Arg(1)->Arg(256);
+
+// submit + wait of a batch of small tasks from a worker, with the pooled futures
+static void taskSubmitWaitPooledFuture(benchmark::State& state)
+{
+    auto const taskCount = static_cast<uint64_t>(state.range(0));
+    auto taskManager = TaskManager{ 2 };
+
+    taskManager
+      .start([&]() -> void {
+          auto& worker = Worker::threadWorker();
+          auto futures = std::vector<Future<uint64_t>>{};
+          futures.reserve(taskCount);
+
+          for (auto _ : state) {
+              for (auto i = uint64_t{ 0 }; i < taskCount; i++)
+                  futures.emplace_back(worker.submitTask([i]() -> uint64_t { return i; }));
+
+              for (auto&& future : futures)
+                  benchmark::DoNotOptimize(worker.waitFor(future));
+
+              futures.clear();
+          }
+      })
+      .get();
+
+    auto steals = taskManager.metrics().total();
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["steal_success_rate"] =
+      steals.stealAttempts > 0 ? static_cast<double>(steals.steals) / static_cast<double>(steals.stealAttempts) : 0.0;
+    state.counters["tasks_per_steal"] =
+      steals.steals > 0 ? static_cast<double>(steals.stolenTasks) / static_cast<double>(steals.steals) : 0.0;
+}
+
+BENCHMARK(taskSubmitWaitPooledFuture)->Arg(64)->Arg(4096)->UseRealTime();
+
+// the same with std::packaged_task, its shared state is on the heap
+static void taskSubmitWaitPackagedTask(benchmark::State& state)
+{
+    auto const taskCount = static_cast<uint64_t>(state.range(0));
+    auto taskManager = TaskManager{ 2 };
+
+    taskManager
+      .start([&]() -> void {
+          auto& worker = Worker::threadWorker();
+          auto futures = std::vector<std::future<uint64_t>>{};
+          futures.reserve(taskCount);
+
+          for (auto _ : state) {
+              for (auto i = uint64_t{ 0 }; i < taskCount; i++) {
+                  auto task = std::packaged_task<uint64_t()>{ [i]() -> uint64_t { return i; } };
+                  futures.emplace_back(task.get_future());
+                  worker.submitDetachedTask(std::move(task));
+              }
+
+              for (auto&& future : futures)
+                  benchmark::DoNotOptimize(worker.waitFor(future));
+
+              futures.clear();
+          }
+      })
+      .get();
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(taskSubmitWaitPackagedTask)->Arg(64)->Arg(4096)->UseRealTime();
@@ -0,0 +1,190 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "animations/internal/interpolation.h"
+#include "animations/sampler.h"
+#include "resources/buffer.h"
+#include "resources/internal/freeRanges.h"
+#include "resources/resourceManager.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace cyclonite;
+
+// resource tags are global, so there is one resource manager for all of the benchmarks
+static auto _resourceManager() -> resources::ResourceManager&
+{
+    static auto resourceManager = []() -> std::unique_ptr<resources::ResourceManager> {
+        auto manager = std::make_unique<resources::ResourceManager>();
+        manager->registerResources(resources::resource_reg_info_t<resources::Buffer, 1024, 16 * 1024 * 1024>{});
+        return manager;
+    }();
+
+    return *resourceManager;
+}
+
+static void resourceManagerCreateErase(benchmark::State& state)
+{
+    auto& resourceManager = _resourceManager();
+    auto const size = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state) {
+        auto id = resourceManager.create<resources::Buffer>(size);
+        benchmark::DoNotOptimize(id);
+        resourceManager.erase(id);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(resourceManagerCreateErase)->Arg(64)->Arg(64 * 1024);
+
+static void resourceManagerGet(benchmark::State& state)
+{
+    auto& resourceManager = _resourceManager();
+    auto ids = std::vector<resources::Resource::Id>{};
+
+    for (auto i = int64_t{ 0 }; i < state.range(0); i++)
+        ids.push_back(resourceManager.create<resources::Buffer>(size_t{ 64 }));
+
+    auto cursor = size_t{ 0 };
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&resourceManager.get(ids[cursor]));
+        cursor = (cursor + 1) % ids.size();
+    }
+
+    for (auto id : ids)
+        resourceManager.erase(id);
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(resourceManagerGet)->Arg(16)->Arg(1024);
+
+// every thread keeps a batch of its own buffers alive, creates and erases them and looks them up in between
+static void resourceManagerConcurrentCreateGetErase(benchmark::State& state)
+{
+    auto& resourceManager = _resourceManager();
+    auto ids = std::vector<resources::Resource::Id>(64);
+
+    for (auto _ : state) {
+        for (auto&& id : ids)
+            id = resourceManager.create<resources::Buffer>(size_t{ 64 });
+
+        for (auto id : ids)
+            benchmark::DoNotOptimize(&resourceManager.get(id));
+
+        for (auto id : ids)
+            resourceManager.erase(id);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ids.size()));
+}
+
+BENCHMARK(resourceManagerConcurrentCreateGetErase)->ThreadRange(1, 8)->UseRealTime();
+
+// the same pattern as for the arena: every other allocation is freed first, then the oldest one is replaced
+static void freeRangesAllocFreeFragmented(benchmark::State& state)
+{
+    auto const liveCount = static_cast<size_t>(state.range(0));
+
+    auto random = std::minstd_rand{ 42 };
+    auto allocationSize = [&random]() -> size_t { return 1 + random() % 1024; };
+
+    auto ranges = resources::internal::FreeRanges{};
+    ranges.free(0, 4 * liveCount * 1024);
+
+    auto allocations = std::vector<std::pair<size_t, size_t>>(liveCount * 2);
+
+    for (auto&& [offset, size] : allocations) {
+        size = allocationSize();
+        offset = *ranges.alloc(size, 16);
+    }
+
+    for (auto i = size_t{ 1 }; i < allocations.size(); i += 2)
+        ranges.free(allocations[i].first, allocations[i].second);
+
+    for (auto i = size_t{ 1 }; i < liveCount; i++)
+        allocations[i] = allocations[i * 2];
+
+    allocations.resize(liveCount);
+
+    auto cursor = size_t{ 0 };
+
+    for (auto _ : state) {
+        auto& [offset, size] = allocations[cursor];
+
+        ranges.free(offset, size);
+
+        size = allocationSize();
+        offset = *ranges.alloc(size, 16);
+
+        cursor = (cursor + 1) % liveCount;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(freeRangesAllocFreeFragmented)->Arg(1024)->Arg(16384);
+
+static void samplerUpdate(benchmark::State& state,
+                          InterpolationType interpolationType,
+                          InterpolationElementType elementType,
+                          size_t componentCount)
+{
+    auto const keyCount = size_t{ 64 };
+
+    // cubic splines keep tangents next to the values
+    auto const valueSize = interpolationType == InterpolationType::CUBIC ? 3 * componentCount : componentCount;
+
+    auto& resourceManager = _resourceManager();
+    auto input = resourceManager.create<resources::Buffer>(keyCount * sizeof(real));
+    auto output = resourceManager.create<resources::Buffer>(keyCount * valueSize * sizeof(real));
+
+    {
+        auto keys = resourceManager.getAs<resources::Buffer>(input).view<real>(0, keyCount);
+        auto values = resourceManager.getAs<resources::Buffer>(output).view<real>(0, keyCount * valueSize);
+
+        for (auto i = size_t{ 0 }; i < keyCount; i++)
+            *(keys.begin() + static_cast<std::ptrdiff_t>(i)) = static_cast<real>(i);
+
+        for (auto i = size_t{ 0 }; i < keyCount * valueSize; i++)
+            *(values.begin() + static_cast<std::ptrdiff_t>(i)) = static_cast<real>(i % 7) / 7.f;
+    }
+
+    auto sampler = animations::Sampler{ resourceManager,
+                                        animations::internal::get_interpolator(interpolationType, elementType),
+                                        input,
+                                        output,
+                                        0,
+                                        sizeof(real),
+                                        0,
+                                        componentCount * sizeof(real),
+                                        keyCount,
+                                        componentCount,
+                                        interpolationType };
+
+    auto playtime = real{ 0.f };
+
+    for (auto _ : state) {
+        sampler.update(playtime);
+        benchmark::DoNotOptimize(sampler.rawValue());
+
+        playtime = std::fmod(playtime + 0.37f, static_cast<real>(keyCount - 1));
+    }
+
+    resourceManager.erase(output);
+    resourceManager.erase(input);
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(samplerUpdate, step_vec3, InterpolationType::STEP, InterpolationElementType::VEC3, 3);
+BENCHMARK_CAPTURE(samplerUpdate, linear_vec3, InterpolationType::LINEAR, InterpolationElementType::VEC3, 3);
+BENCHMARK_CAPTURE(samplerUpdate, spherical_quat, InterpolationType::SPHERICAL, InterpolationElementType::QUAT, 4);
+BENCHMARK_CAPTURE(samplerUpdate, cubic_vec3, InterpolationType::CUBIC, InterpolationElementType::VEC3, 3);
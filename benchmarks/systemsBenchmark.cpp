@@ -0,0 +1,110 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "components/transformStorage.h"
+#include "systems/meshSystem.h"
+#include "systems/transformSystem.h"
+#include <benchmark/benchmark.h>
+#include <enttx/enttx.h>
+#include <limits>
+#include <vector>
+
+using namespace cyclonite;
+
+using transform_entity_manager_t = enttx::EntityManager<
+  enttx::EntityManagerConfig<metrix::type_list<components::Transform>,
+                             metrix::type_list<components::TransformStorage<32, 1>>>>;
+
+using transform_system_manager_t =
+  enttx::SystemManager<enttx::SystemManagerConfig<metrix::value_cast(systems::UpdateStage::COUNT),
+                                                  metrix::type_list<systems::TransformSystem>>>;
+
+// the same number of transforms in chains of different depth, the roots move every frame
+static void transformSystemUpdate(benchmark::State& state)
+{
+    auto const transformCount = size_t{ 4096 };
+    auto const depth = static_cast<size_t>(state.range(0));
+
+    auto entities = transform_entity_manager_t{};
+    auto systems = transform_system_manager_t{};
+
+    auto& transformSystem = systems.get<systems::TransformSystem>();
+    transformSystem.init();
+
+    auto pool = entities.create(
+      std::vector<enttx::Entity>(transformCount, enttx::Entity{ std::numeric_limits<uint64_t>::max() }));
+
+    auto roots = std::vector<enttx::Entity>{};
+
+    for (auto i = size_t{ 0 }; i < transformCount; i++) {
+        auto const isRoot = (i % depth) == 0;
+        auto const parent = isRoot ? enttx::Entity{ std::numeric_limits<uint64_t>::max() } : pool[i - 1];
+
+        transformSystem.create(entities, parent, pool[i], mat4{ 1.f });
+
+        if (isRoot)
+            roots.push_back(pool[i]);
+    }
+
+    auto node = 0; // the system does not look at the node
+    auto frameNumber = uint64_t{ 0 };
+
+    for (auto _ : state) {
+        for (auto root : roots) {
+            auto* transform = entities.getComponent<components::Transform>(root);
+
+            transform->position.x += 0.001f;
+            transform->state = components::Transform::State::UPDATE_LOCAL;
+        }
+
+        systems.update(entities, node, ++frameNumber, real{ 0.016f });
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(transformCount));
+}
+
+BENCHMARK(transformSystemUpdate)->Arg(1)->Arg(8)->Arg(64);
+
+// what the mesh system does every frame for the visible instances: counts instances per draw command,
+// compacts the commands into the indirect buffer and writes the instance matrices
+static void meshSystemInstancePacking(benchmark::State& state)
+{
+    auto const commandCount = size_t{ 64 };
+    auto const instanceCount = static_cast<size_t>(state.range(0));
+
+    auto commands = std::vector<VkDrawIndexedIndirectCommand>(commandCount);
+    auto indirect = std::vector<VkDrawIndexedIndirectCommand>(commandCount);
+    auto instances = std::vector<instanced_data_t>(instanceCount);
+    auto matrices = std::vector<mat4>(instanceCount, mat4{ 1.f });
+
+    // some of the commands have no instances
+    auto commandIndex = [commandCount](size_t instance) -> size_t { return (instance * 7) % (commandCount - 8); };
+
+    for (auto i = size_t{ 0 }; i < commandCount; i++) {
+        commands[i].indexCount = 36;
+        commands[i].firstIndex = static_cast<uint32_t>(i * 36);
+    }
+
+    for (auto _ : state) {
+        for (auto i = size_t{ 0 }; i < instanceCount; i++)
+            commands[commandIndex(i)].instanceCount++;
+
+        auto packedCount = systems::MeshSystem::packCommands(commands, indirect.data());
+        benchmark::DoNotOptimize(packedCount);
+
+        for (auto i = size_t{ 0 }; i < instanceCount; i++) {
+            auto& command = commands[commandIndex(i)];
+            systems::MeshSystem::packInstance(matrices[i], instances[command.firstInstance + command.instanceCount++]);
+        }
+
+        for (auto&& command : commands)
+            command.instanceCount = 0;
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(instanceCount));
+}
+
+BENCHMARK(meshSystemInstancePacking)->Arg(1024)->Arg(16384);
@@ -29,6 +29,7 @@ class CycloniteRecipe(ConanFile):
 
     def requirements(self):
         self.requires("gtest/[~1.16]")
+        self.requires("benchmark/[~1.9]")
         self.requires("metrix/[~1.5]")
         self.requires("taskweaver/[~0.3]")
         self.requires("enttx/4.0.4.0")
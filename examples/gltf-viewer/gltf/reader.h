@@ -151,7 +151,7 @@ auto _readArray(nlohmann::json const& array) -> std::array<T, Size>
 enum class ReaderDataType : uint8_t
 {
     BUFFER_BYTES,
-    BUFFER_STREAM,
+    BUFFER_FILE,
     BUFFER_VIEW,
     ACCESSOR,
     NODE,
@@ -389,18 +389,8 @@ void Reader::read(std::istream& stream, F&& f)
 
             auto path = basePath_ / bufferUri;
 
-            {
-                std::ifstream file{};
-
-                file.exceptions(std::ios::failbit);
-                file.open(path.string(), std::ifstream::binary);
-                file.exceptions(std::ios::badbit);
-                file.seekg(0, std::ifstream::beg);
-
-                f(reader_data_type_t<ReaderDataType::BUFFER_STREAM>{}, i, byteLength, std::ref(file));
-
-                file.close();
-            }
+            // the file is not read here, so the consumer can map it instead of copying
+            f(reader_data_type_t<ReaderDataType::BUFFER_FILE>{}, i, byteLength, path);
         }
     }
 
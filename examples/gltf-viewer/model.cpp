@@ -41,9 +41,9 @@ void Model::init(cyclonite::Root& root,
     constexpr auto expectedGeometryCount = size_t{ 32 };
     constexpr auto expectedAnimationCount = size_t{ 1 };
 
-    constexpr auto initialInterpolationTaskCount = size_t{ 256 };
     constexpr auto initialSamplersCount = size_t{ 1024 };
-    constexpr auto initialBufferMemory = size_t{ 64 * 1024 * 1024 };
+    // buffers are mapped from the files, the memory is for the ones which are filled in place
+    constexpr auto initialBufferMemory = size_t{ 1024 * 1024 };
     constexpr auto initialStagingMemory = size_t{ 64 * 1024 * 1024 };
 
     root.resourceManager().registerResources(
@@ -57,10 +57,6 @@ void Model::init(cyclonite::Root& root,
       cyclonite::resources::resource_reg_info_t<cyclonite::animations::SamplerArray,
                                                 expectedAnimationCount,
                                                 initialSamplersCount * sizeof(cyclonite::animations::Sampler)>{},
-      cyclonite::resources::resource_reg_info_t<cyclonite::animations::AnimationInterpolationTaskArray,
-                                                expectedAnimationCount,
-                                                initialInterpolationTaskCount *
-                                                  sizeof(cyclonite::animations::AnimationInterpolationTaskArray)>{},
       cyclonite::resources::resource_reg_info_t<cyclonite::animations::Animation, expectedAnimationCount, 0>{});
 
     // init systems::
@@ -115,11 +111,11 @@ void Model::init(cyclonite::Root& root,
     reader.read(path, [&](auto dataType, auto&&... args) -> void {
         auto&& t = std::forward_as_tuple(args...);
 
-        if constexpr (gltf::reader_data_test<gltf::ReaderDataType::BUFFER_STREAM, decltype(dataType)>()) {
-            auto&& [bufferIndex, bufferSize, stream] = t;
+        if constexpr (gltf::reader_data_test<gltf::ReaderDataType::BUFFER_FILE, decltype(dataType)>()) {
+            auto&& [bufferIndex, bufferSize, bufferPath] = t;
 
-            auto bufferId = root.resourceManager().template create<cyclonite::resources::Buffer>(bufferSize);
-            root.resourceManager().get(bufferId).load(stream);
+            auto bufferId =
+              root.resourceManager().template create<cyclonite::resources::Buffer>(bufferPath, bufferSize);
 
             gltfBufferIndexToResourceId.insert(std::pair{ static_cast<size_t>(bufferIndex), bufferId });
         }
@@ -187,7 +183,8 @@ void Model::init(cyclonite::Root& root,
 
                 assert(gltfBufferIndexToResourceId.count(posBufferIdx));
                 auto posBufferId = gltfBufferIndexToResourceId[posBufferIdx];
-                auto& posBuffer = root.resourceManager().get(posBufferId).template as<cyclonite::resources::Buffer>();
+                auto const& posBuffer =
+                  std::as_const(root.resourceManager()).get(posBufferId).template as<cyclonite::resources::Buffer>();
 
                 auto const& norBufferView = reader.bufferViews()[normalBufferViewIdx];
                 auto&& [norBufferIdx, norByteOffset, norByteLength, norByteStride] = norBufferView;
@@ -195,7 +192,8 @@ void Model::init(cyclonite::Root& root,
 
                 assert(gltfBufferIndexToResourceId.count(norBufferIdx));
                 auto norBufferId = gltfBufferIndexToResourceId[norBufferIdx];
-                auto& norBuffer = root.resourceManager().get(norBufferId).template as<cyclonite::resources::Buffer>();
+                auto const& norBuffer =
+                  std::as_const(root.resourceManager()).get(norBufferId).template as<cyclonite::resources::Buffer>();
 
                 auto posStride = posByteStride == 0
                                    ? posType == reinterpret_cast<char const*>(u8"vec4") ? sizeof(vec4) : sizeof(vec3)
@@ -232,7 +230,8 @@ void Model::init(cyclonite::Root& root,
 
                 assert(gltfBufferIndexToResourceId.count(idxBufferIdx));
                 auto idxBufferId = gltfBufferIndexToResourceId[idxBufferIdx];
-                auto& idxBuffer = root.resourceManager().get(idxBufferId).template as<cyclonite::resources::Buffer>();
+                auto const& idxBuffer =
+                  std::as_const(root.resourceManager()).get(idxBufferId).template as<cyclonite::resources::Buffer>();
 
                 switch (indexComponentType) {
                     case 5121: { // unsigned byte
@@ -120,6 +120,8 @@ auto Viewer::init(cyclonite::Options options) -> Viewer&
 auto Viewer::run() -> Viewer&
 {
     auto mainTask = [this]() -> void {
+        constexpr auto compactionBudget = size_t{ 256 * 1024 };
+
         auto start = std::chrono::high_resolution_clock::now();
 
         while (controller_->alive()) {
@@ -129,6 +131,9 @@ auto Viewer::run() -> Viewer&
 
             start = end;
 
+            // between the frames nothing touches the resources, so a bit of fragmentation is paid off
+            root_->resourceManager().compact(compactionBudget);
+
             controller_->update(*model_, dt);
 
             view_->draw(root_->device());
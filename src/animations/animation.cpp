@@ -10,14 +10,17 @@
 namespace cyclonite::animations {
 resources::Resource::ResourceTag Animation::tag{};
 
+// sampler updates are cheap, so the grain is small enough to balance uneven samplers
+static constexpr auto _samplersPerGrain = size_t{ 8 };
+
 Animation::Animation(multithreading::TaskManager& taskManager,
                      uint32_t sampleCount,
                      real duration,
                      bool autoplay) noexcept
   : resources::Resource{}
   , taskManager_{ &taskManager }
-  , interpolationTaskArrayId_{}
   , samplerArrayId_{}
+  , relocationCount_{ 0 }
   , lastFrameUpdate_{ std::numeric_limits<uint64_t>::max() }
   , sampleCount_{ sampleCount }
   , playtime_{ 0.f }
@@ -39,15 +42,6 @@ Animation::Animation(multithreading::TaskManager& taskManager, uint32_t sampleCo
 void Animation::handlePostAllocation()
 {
     samplerArrayId_ = resourceManager().template create<SamplerArray>(sampleCount_);
-
-    auto samplesPerTask = std::max(1u, sampleCount_ / taskManager_->workerCount());
-    auto taskCount = (sampleCount_ / samplesPerTask) + static_cast<uint32_t>((sampleCount_ % samplesPerTask) > 0);
-
-    assert(taskCount < std::numeric_limits<uint16_t>::max());
-    assert(samplesPerTask < std::numeric_limits<uint16_t>::max());
-
-    interpolationTaskArrayId_ = resourceManager().template create<AnimationInterpolationTaskArray>(
-      static_cast<uint16_t>(taskCount), static_cast<uint16_t>(samplesPerTask));
 }
 
 void Animation::beginUpdate(real dt)
@@ -90,29 +84,26 @@ bool Animation::endUpdate()
 
 void Animation::_update()
 {
-    auto& interpolationTasks =
-      resourceManager().get(interpolationTaskArrayId_).template as<AnimationInterpolationTaskArray>();
-
     auto& samplers = resourceManager().get(samplerArrayId_).template as<SamplerArray>();
 
-    auto itemsPerTask = interpolationTasks.itemsPerTask();
-    for (size_t i = 0, count = interpolationTasks.count(); i < count; i++) {
-        auto from = samplers.begin() + static_cast<ptrdiff_t>(i * itemsPerTask);
-        auto to = from + ((i * itemsPerTask + itemsPerTask <= samplers.count())
-                            ? static_cast<ptrdiff_t>(itemsPerTask)
-                            : static_cast<ptrdiff_t>(samplers.count() - i * itemsPerTask));
-
-        assert(multithreading::Worker::isInWorkerThread());
-
-        interpolationTasks[i] =
-          multithreading::Worker::threadWorker().submitTask([from, to, playtime = playtime_]() -> void {
-              for (auto it = from; it != to; it++) {
-                  (*it).update(playtime);
-              }
-          });
+    // the buffers could be moved by the compaction since the last update
+    if (auto relocationCount = resourceManager().relocationCount(); relocationCount != relocationCount_) {
+        for (auto& sampler : samplers) {
+            sampler.rebind(resourceManager());
+        }
+
+        relocationCount_ = relocationCount;
     }
 
-    interpolationTasks.resolve();
+    taskManager_->parallelFor(
+      size_t{ 0 },
+      samplers.count(),
+      _samplersPerGrain,
+      [&samplers, playtime = playtime_](size_t first, size_t last) -> void {
+          for (auto i = first; i < last; i++) {
+              samplers[i].update(playtime);
+          }
+      });
 }
 
 void Animation::play()
@@ -176,16 +167,4 @@ void Animation::setupSampler(size_t samplerIndex,
     sampler = Sampler{ resourceManager(), interpolator_func, inBufferId,   outBufferId,    inOffset,         inStride,
                        outOffset,         outStride,         elementCount, componentCount, interpolationType };
 }
-
-AnimationInterpolationTaskArray::AnimationInterpolationTaskArray(uint16_t taskCount, uint16_t itemsPerTask)
-  : resources::ContiguousData<std::future<void>>{ taskCount }
-  , itemsPerTask_{ itemsPerTask }
-{
-}
-
-void AnimationInterpolationTaskArray::resolve()
-{
-    for (auto&& task : *this)
-        task.get();
 }
-}
\ No newline at end of file
@@ -8,7 +8,6 @@
 #include "resources/contiguousData.h"
 #include "sampler.h"
 #include <bitset>
-#include <future>
 #include <glm/gtc/type_ptr.hpp>
 #include <metrix/enum.h>
 
@@ -21,19 +20,6 @@ class TaskManager;
 namespace cyclonite::animations {
 using SamplerArray = resources::ContiguousData<Sampler>;
 
-class AnimationInterpolationTaskArray : public resources::ContiguousData<std::future<void>>
-{
-public:
-    AnimationInterpolationTaskArray(uint16_t taskCount, uint16_t itemsPerTask);
-
-    [[nodiscard]] auto itemsPerTask() const -> uint16_t { return itemsPerTask_; }
-
-    void resolve();
-
-private:
-    uint16_t itemsPerTask_;
-};
-
 class Animation : public resources::Resource
 {
     enum class AnimationBits
@@ -112,8 +98,8 @@ private:
     auto _samplers() -> SamplerArray&;
 
     multithreading::TaskManager* taskManager_;
-    resources::Resource::Id interpolationTaskArrayId_;
     resources::Resource::Id samplerArrayId_;
+    uint64_t relocationCount_; // of the resource manager, when the samplers took their views
 
     uint64_t lastFrameUpdate_;
     uint32_t sampleCount_;
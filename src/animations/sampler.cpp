@@ -5,6 +5,7 @@
 #include "sampler.h"
 #include "resources/buffer.h"
 #include "resources/resourceManager.h"
+#include <utility>
 
 namespace cyclonite::animations {
 Sampler::Sampler() noexcept
@@ -13,6 +14,8 @@ Sampler::Sampler() noexcept
   , outputBufferId_{}
   , input_{ nullptr, std::numeric_limits<size_t>::max(), 0 }
   , output_{ nullptr, std::numeric_limits<size_t>::max(), 0 }
+  , inOffset_{ 0 }
+  , outOffset_{ 0 }
   , rawValue_{}
   , interpolationType_{ InterpolationType::STEP }
   , componentCount_{ 0 }
@@ -33,18 +36,34 @@ Sampler::Sampler(resources::ResourceManager& resourceManager,
   : interpolate_{ interpolator }
   , inputBufferId_{ inBufferId }
   , outputBufferId_{ outBufferId }
-  , input_{ resourceManager.get(inBufferId)
+  , input_{ std::as_const(resourceManager)
+              .get(inBufferId)
               .template as<resources::Buffer>()
               .view<real>(inOffset, valueCount, inStride) }
-  , output_{ resourceManager.get(outBufferId)
+  , output_{ std::as_const(resourceManager)
+               .get(outBufferId)
                .template as<resources::Buffer>()
                .view<real>(outOffset, valueCount * componentCount, outStride) }
+  , inOffset_{ inOffset }
+  , outOffset_{ outOffset }
   , rawValue_{}
   , interpolationType_{ interpolationType }
   , componentCount_{ static_cast<uint8_t>(componentCount) }
 {
 }
 
+void Sampler::rebind(resources::ResourceManager& resourceManager)
+{
+    if (!resourceManager.isValid(inputBufferId_) || !resourceManager.isValid(outputBufferId_))
+        return;
+
+    auto const& input = std::as_const(resourceManager).get(inputBufferId_).template as<resources::Buffer>();
+    auto const& output = std::as_const(resourceManager).get(outputBufferId_).template as<resources::Buffer>();
+
+    input_ = input.view<real>(inOffset_, input_.count(), input_.stride());
+    output_ = output.view<real>(outOffset_, output_.count(), output_.stride());
+}
+
 void Sampler::update(real playtime)
 {
     assert(input_.count() > 0);
@@ -39,6 +39,9 @@ public:
 
     void update(real playtime);
 
+    // takes the views again after the buffers were moved by the compaction
+    void rebind(resources::ResourceManager& resourceManager);
+
     template<typename ValueType>
     [[nodiscard]] auto value(make_func_t<ValueType> makeFunc) const -> ValueType;
 
@@ -49,8 +52,11 @@ private:
     resources::Resource::Id inputBufferId_;
     resources::Resource::Id outputBufferId_;
 
-    buffers::BufferView<real> input_;
-    buffers::BufferView<real> output_;
+    buffers::BufferView<real const> input_;
+    buffers::BufferView<real const> output_;
+
+    size_t inOffset_;
+    size_t outOffset_;
 
     std::array<real, 16> rawValue_;
 
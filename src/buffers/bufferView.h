@@ -8,11 +8,16 @@
 #include <cassert>
 #include <cstddef>
 #include <iterator>
+#include <type_traits>
 
 namespace cyclonite::buffers {
+// a view of const data (e.g. BufferView<real const>) is made from a pointer to const
 template<typename DataType>
 class BufferView
 {
+    using byte_t = std::conditional_t<std::is_const_v<DataType>, std::byte const, std::byte>;
+    using data_pointer_t = std::conditional_t<std::is_const_v<DataType>, void const*, void*>;
+
 public:
     class Iterator
     {
@@ -65,7 +70,7 @@ public:
     };
 
 public:
-    BufferView(void* dataPtr, size_t offset, size_t count, size_t stride = sizeof(DataType));
+    BufferView(data_pointer_t dataPtr, size_t offset, size_t count, size_t stride = sizeof(DataType));
 
     auto begin() const -> Iterator { return Iterator{ *this, 0l }; }
 
@@ -76,14 +81,14 @@ public:
     [[nodiscard]] auto stride() const -> size_t { return stride_; }
 
 private:
-    void* ptr_;
+    data_pointer_t ptr_;
     size_t stride_;
     size_t count_;
 };
 
 template<typename DataType>
-BufferView<DataType>::BufferView(void* dataPtr, size_t offset, size_t count, size_t stride)
-  : ptr_{ reinterpret_cast<std::byte*>(dataPtr) + offset }
+BufferView<DataType>::BufferView(data_pointer_t dataPtr, size_t offset, size_t count, size_t stride)
+  : ptr_{ static_cast<byte_t*>(dataPtr) + offset }
   , stride_{ stride }
   , count_{ count }
 {
@@ -169,7 +174,7 @@ auto BufferView<DataType>::Iterator::operator-(Iterator const& rhs) -> differenc
 template<typename DataType>
 auto BufferView<DataType>::Iterator::operator->() const -> DataType*
 {
-    void* p = reinterpret_cast<std::byte*>(view_->ptr_) + view_->stride_ * index_;
+    auto* p = static_cast<byte_t*>(view_->ptr_) + view_->stride_ * index_;
     return reinterpret_cast<DataType*>(p);
 }
 
@@ -194,7 +199,7 @@ auto BufferView<DataType>::Iterator::ptr() const -> DataType*
 template<typename DataType>
 auto BufferView<DataType>::Iterator::operator[](int index) const -> reference
 {
-    void* p = reinterpret_cast<std::byte*>(view_->ptr_) + view_->stride_ * index;
+    auto* p = static_cast<byte_t*>(view_->ptr_) + view_->stride_ * index;
     return *(reinterpret_cast<DataType*>(p));
 }
 }
@@ -8,6 +8,8 @@
 #include "baseGraphicsNode.h"
 #include "nodeAsset.h"
 #include "passIterator.h"
+#include "profiling/hardwareCounters.h"
+#include "profiling/tracer.h"
 #include "typedefs.h"
 #include "vulkan/shaderModule.h"
 
@@ -184,6 +186,9 @@ void GraphicsNode<Config>::makeDescriptorSetExpired()
 template<NodeConfig Config>
 void GraphicsNode<Config>::update(uint32_t& semaphoreCount, uint64_t frameNumber, real deltaTime)
 {
+    CYCLONITE_ZONE_ARG("GraphicsNode::update", id());
+    CYCLONITE_COUNTERS_ARG("GraphicsNode::update", id());
+
     auto& a = resourceManager().get(asset()).template as<asset_t>();
     systems_.update(a.entities(), *this, semaphoreCount, frameNumber, deltaTime);
 }
@@ -252,8 +257,8 @@ void GraphicsNode<Config>::writeFrameCommands(vulkan::Device& device)
         frameUpdateTask();
     } else {
         assert(multithreading::Worker::isInWorkerThread());
-        auto future = multithreading::Worker::threadWorker().taskManager().submitRenderTask(frameUpdateTask);
-        future.get();
+        auto& worker = multithreading::Worker::threadWorker();
+        worker.waitFor(worker.taskManager().submitRenderTask(frameUpdateTask));
     }
 }
 
@@ -665,7 +665,7 @@ auto BaseGraphicsNode::Builder<Config>::build() -> GraphicsNode<Config>
     node.publicSemanticBits_ = publicSemanticBits_;
 
     for (auto&& dep : dependencies_) {
-        node.dependencies_.insert(std::pair{ nameToNodeId_(dep), std::nullopt });
+        node.dependencies_.push_back(nameToNodeId_(dep));
     }
 
     return node;
@@ -7,6 +7,8 @@
 
 #include "baseLogicNode.h"
 #include "nodeAsset.h"
+#include "profiling/hardwareCounters.h"
+#include "profiling/tracer.h"
 #include "typedefs.h"
 
 namespace cyclonite::compositor {
@@ -57,6 +59,9 @@ LogicNode<Config>::LogicNode(resources::ResourceManager& resourceManager, std::s
 template<NodeConfig Config>
 void LogicNode<Config>::update(uint64_t frameNumber, real deltaTime)
 {
+    CYCLONITE_ZONE_ARG("LogicNode::update", id());
+    CYCLONITE_COUNTERS_ARG("LogicNode::update", id());
+
     auto& a = resourceManager().get(asset()).template as<asset_t>();
     systems_.update(a.entities(), *this, frameNumber, deltaTime);
 }
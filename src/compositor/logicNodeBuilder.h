@@ -58,6 +58,7 @@ template<NodeConfig Config>
 auto BaseLogicNode::Builder<Config>::addDependency(std::string_view name) -> Builder&
 {
     dependencies_.emplace_back(name);
+    return *this;
 }
 
 template<NodeConfig Config>
@@ -66,7 +67,7 @@ auto BaseLogicNode::Builder<Config>::build() -> LogicNode<Config>
     auto node = LogicNode<Config>{ *resourceManager_, std::string_view{ name_.data(), name_.size() }, nodeTypeId_ };
 
     for (auto&& dep : dependencies_) {
-        node.dependencies_.insert(std::pair{ nameToNodeId_(dep), std::nullopt });
+        node.dependencies_.push_back(nameToNodeId_(dep));
     }
 
     return node;
@@ -17,29 +17,4 @@ Node::Node(resources::ResourceManager& resourceManager,
 #endif
 {
 }
-
-void Node::resolveDependencies()
-{
-    for (auto&& [_, dep] : dependencies_) {
-        (void)_;
-        assert(dep);
-
-        dep->get();
-    }
-}
-
-void Node::updateDependency(uint64_t id, std::shared_future<void> const& dependency)
-{
-    assert(dependencies_.contains(id));
-    dependencies_[id] = dependency;
-}
-
-void Node::clearDependencies()
-{
-    std::for_each(dependencies_.begin(), dependencies_.end(), [](auto&& d) -> void {
-        auto&& [id, dependency] = d;
-        (void)id;
-        dependency = std::nullopt;
-    });
 }
-}
\ No newline at end of file
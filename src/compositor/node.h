@@ -9,9 +9,8 @@
 #include "nodeIdentifier.h"
 #include "nodeTypeRegister.h"
 #include "resources/resource.h"
-#include <future>
-#include <optional>
-#include <unordered_map>
+#include <algorithm>
+#include <vector>
 
 namespace cyclonite::compositor {
 class Node : public NodeIdentifier
@@ -38,18 +37,17 @@ public:
     template<NodeConfig Config, typename NodeTypeId>
     auto as(type_pair<Config, NodeTypeId>) -> node_t<Config>&;
 
-    auto dependsOn(uint64_t id) const -> bool { return dependencies_.contains(id); }
-
-    void updateDependency(uint64_t id, std::shared_future<void> const& dependency);
-
-    void resolveDependencies();
+    [[nodiscard]] auto dependsOn(uint64_t id) const -> bool
+    {
+        return std::find(dependencies_.begin(), dependencies_.end(), id) != dependencies_.end();
+    }
 
-    void clearDependencies();
+    [[nodiscard]] auto dependencies() const -> std::vector<uint64_t> const& { return dependencies_; }
 
 protected:
     Node(resources::ResourceManager& resourceManager, std::string_view name, [[maybe_unused]] uint64_t typeId) noexcept;
 
-    std::unordered_map<uint64_t, std::optional<std::shared_future<void>>> dependencies_;
+    std::vector<uint64_t> dependencies_;
 
 private:
     resources::ResourceManager* resourceManager_;
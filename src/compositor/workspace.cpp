@@ -18,8 +18,10 @@ Workspace::Workspace() noexcept
   , nameToGraphicsNodeIndex_{}
   , frameNumber_{ 0 }
   , submits_{}
-  , gfxFutures_{}
   , submitCount_{ 0 }
+  , frameGraph_{ nullptr }
+  , frameDeltaTime_{ 0.0f }
+  , frameFence_{ VK_NULL_HANDLE }
   , frameFences_{}
   , lastTimeUpdate_{ std::chrono::high_resolution_clock::now() }
 {
@@ -27,6 +29,8 @@ Workspace::Workspace() noexcept
 
 void Workspace::render(vulkan::Device& device)
 {
+    CYCLONITE_ZONE_ARG("Workspace::render", frameNumber_);
+
     beginFrame();
 
     // TODO:: receive as argument instead
@@ -34,144 +38,128 @@ void Workspace::render(vulkan::Device& device)
     auto dt = std::min(std::chrono::duration<real, std::ratio<1>>{ updateTime - lastTimeUpdate_ }.count(), 0.1f);
 
     lastTimeUpdate_ = updateTime;
+    frameDeltaTime_ = dt;
 
-    // logic nodes update
-    for (auto lni = uint8_t{ 0 }; lni < logicNodeCount_; lni++) {
-        auto& node = logicNodes_[lni];
+    if (!frameGraph_)
+        _buildFrameGraph(device);
 
-        auto future = std::shared_future<void>{ multithreading::Worker::threadWorker().submitTask(
-          [frameNumber = frameNumber_, node = node /* just copy interface */, dt]() mutable -> void {
-              node.get().resolveDependencies();
-              node.update(frameNumber, dt);
-          }) };
+    // nodes wait for nothing, every node is submitted when the last of its dependencies is over
+    frameGraph_->run();
 
-        // further nodes
-        for (auto j = lni; j < logicNodeCount_; j++) {
-            auto& n = logicNodes_[j];
-            auto id = node.get().id();
+    // submits everything and swap buffers
+    endFrame(device, frameFence_);
+}
 
-            if (n.get().dependsOn(id)) {
-                n.get().updateDependency(id, future);
-            }
-        }
+void Workspace::_buildFrameGraph(vulkan::Device& device)
+{
+    using node_id_t = multithreading::TaskGraph::node_id_t;
 
-        for (auto k = uint8_t{ 0 }; k < graphicsNodeCount_; k++) {
-            auto& gn = graphicsNodes_[k];
-            auto id = node.get().id();
+    // frame work goes ahead of streaming and other background tasks
+    auto graph = std::make_unique<multithreading::TaskGraph>(multithreading::TaskPriority::FRAME_CRITICAL);
 
-            if (gn.get().dependsOn(id)) {
-                gn.get().updateDependency(id, future);
-            }
-        }
+    for (auto lni = uint8_t{ 0 }; lni < logicNodeCount_; lni++) {
+        graph->addNode([this, lni]() -> void { logicNodes_[lni].update(frameNumber_, frameDeltaTime_); });
     }
 
-    // frame sync
-    auto fence = syncFrame(device);
+    auto frameSync = graph->addNode([this, &device]() -> void { frameFence_ = syncFrame(device); });
 
     for (auto gni = uint8_t{ 0 }; gni < graphicsNodeCount_; gni++) {
-        auto& node = graphicsNodes_[gni];
-
-        // it's going to be not trivial thing to execute gfx node in the parallel
-        // but let's try
-        auto future = std::shared_future<void>{ multithreading::Worker::threadWorker().submitTask(
-          [&graphicsNodes = graphicsNodes_,                    // read only
-             & idToGraphicsNodeIndex = idToGraphicsNodeIndex_, // read only
-           frameNumber = frameNumber_,                         // read only
-           node = node,                                        // just copy interface
-           dt,
-           &device]() mutable -> void {
-              node.get().resolveDependencies();
-
-              // safe
-              auto semaphoreCount = uint32_t{ 0 };
-              auto [baseSemaphore, baseDstStageMask] = node.waitStages();
-
-              // node::begin modifies frame buffer index and have to be in the render thread
-              // to avoid data races
-              auto beginFuture = multithreading::Worker::threadWorker().taskManager().submitRenderTask(
-                [&node, &device]() -> std::pair<VkSemaphore, size_t> { return node.begin(device); });
-              auto [renderTargetReadySemaphore, commandIndex] = beginFuture.get();
-
-              if (renderTargetReadySemaphore != VK_NULL_HANDLE) { // to waiting for acquired image or frame buffer
-                  *(baseSemaphore + semaphoreCount) = renderTargetReadySemaphore;
-                  *(baseDstStageMask + semaphoreCount) = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-                  semaphoreCount++;
-              }
-
-              // reads input frame buffer index and must be in the render thread
-              auto inputUpdateFuture = multithreading::Worker::threadWorker().taskManager().submitRenderTask(
-                [&node,
-                 &graphicsNodes,
-                 &idToGraphicsNodeIndex,
-                 &semaphoreCount,
-                 baseSemaphore = baseSemaphore,
-                 baseDstStageMask = baseDstStageMask]() -> void {
-                    auto& inputs = node.get().inputs();
-
-                    for (size_t linkIdx = 0, linkCount = inputs.size(); linkIdx < linkCount; linkIdx++) {
-                        auto& [inputNodeId, sampler, views, semantics] = inputs.get(linkIdx);
-                        (void)sampler;
-
-                        if (inputNodeId == std::numeric_limits<size_t>::max())
-                            continue;
-
-                        assert(idToGraphicsNodeIndex.contains(inputNodeId));
-                        auto const& inputNode = graphicsNodes[idToGraphicsNodeIndex[inputNodeId]];
-
-                        auto signal = inputNode.get().passFinishedSemaphore();
-                        if (signal != VK_NULL_HANDLE) { // to wait all nodes this node depends on
-                            *(baseSemaphore + semaphoreCount) = signal;
-                            *(baseDstStageMask + semaphoreCount) = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-                            semaphoreCount++;
-                        }
-
-                        auto const inputFrameBufferIndex = inputNode.get().frameBufferIndex();
-                        for (auto i = size_t{ 0 }; i < value_cast(RenderTargetOutputSemantic::COUNT); i++) {
-                            auto const& rt = inputNode.isSurfaceNode()
-                                               ? static_cast<BaseRenderTarget const&>(
-                                                   (*inputNode).getRenderTarget<SurfaceRenderTarget>())
-                                               : static_cast<BaseRenderTarget const&>(
-                                                   (*inputNode).getRenderTarget<FrameBufferRenderTarget>());
-
-                            auto semantic = semantics[i];
-
-                            if (semantic != RenderTargetOutputSemantic::INVALID) {
-                                auto& view = views[i];
-                                auto const& attachment = rt.getColorAttachment(inputFrameBufferIndex, semantic);
-
-                                if (view != attachment.handle()) {
-                                    view = attachment.handle();
-                                    node.makeDescriptorSetExpired();
-                                }
-                            }
-                        } // input semantics
-                    }     // all inputs
-                });
-              inputUpdateFuture.get();
-
-              // it has to be safe after dependency resolve
-              node.update(semaphoreCount, frameNumber, dt);
-
-              // writes own submit info only
-              node.end(semaphoreCount);
-          }) };
-
-        // further nodes
-        for (auto j = gni; j < graphicsNodeCount_; j++) {
-            auto& n = graphicsNodes_[j];
-            auto id = node.get().id();
-
-            if (n.get().dependsOn(id)) {
-                n.get().updateDependency(id, future);
-            }
+        // the node is over when the coroutine is, no worker is blocked while it is in the render thread
+        auto id = graph->addNode(
+          [this, &device, gni]() -> multithreading::Coroutine<> { return _updateGraphicsNode(device, gni); });
+
+        graph->addEdge(frameSync, id);
+    }
+
+    auto graphNodeId = [this, frameSync](uint64_t nodeId) -> node_id_t {
+        if (auto it = idToLogicNodeIndex_.find(nodeId); it != idToLogicNodeIndex_.end())
+            return static_cast<node_id_t>(it->second);
+
+        assert(idToGraphicsNodeIndex_.contains(nodeId));
+        return static_cast<node_id_t>(frameSync + 1 + idToGraphicsNodeIndex_.at(nodeId));
+    };
+
+    for (auto lni = uint8_t{ 0 }; lni < logicNodeCount_; lni++) {
+        for (auto dependency : logicNodes_[lni].get().dependencies())
+            graph->addEdge(graphNodeId(dependency), static_cast<node_id_t>(lni));
+    }
+
+    for (auto gni = uint8_t{ 0 }; gni < graphicsNodeCount_; gni++) {
+        for (auto dependency : graphicsNodes_[gni].get().dependencies())
+            graph->addEdge(graphNodeId(dependency), static_cast<node_id_t>(frameSync + 1 + gni));
+    }
+
+    frameGraph_ = std::move(graph);
+}
+
+auto Workspace::_updateGraphicsNode(vulkan::Device& device, uint8_t index) -> multithreading::Coroutine<>
+{
+    auto& node = graphicsNodes_[index];
+
+    // safe
+    auto semaphoreCount = uint32_t{ 0 };
+    auto [baseSemaphore, baseDstStageMask] = node.waitStages();
+
+    // node::begin modifies frame buffer index and the inputs read frame buffer indices of the others,
+    // so both have to be in the render thread to avoid data races
+    co_await multithreading::toRenderThread();
+
+    auto [renderTargetReadySemaphore, commandIndex] = node.begin(device);
+    (void)commandIndex;
+
+    if (renderTargetReadySemaphore != VK_NULL_HANDLE) { // to waiting for acquired image or frame buffer
+        *(baseSemaphore + semaphoreCount) = renderTargetReadySemaphore;
+        *(baseDstStageMask + semaphoreCount) = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        semaphoreCount++;
+    }
+
+    auto& inputs = node.get().inputs();
+
+    for (size_t linkIdx = 0, linkCount = inputs.size(); linkIdx < linkCount; linkIdx++) {
+        auto& [inputNodeId, sampler, views, semantics] = inputs.get(linkIdx);
+        (void)sampler;
+
+        if (inputNodeId == std::numeric_limits<size_t>::max())
+            continue;
+
+        assert(idToGraphicsNodeIndex_.contains(inputNodeId));
+        auto const& inputNode = graphicsNodes_[idToGraphicsNodeIndex_[inputNodeId]];
+
+        auto signal = inputNode.get().passFinishedSemaphore();
+        if (signal != VK_NULL_HANDLE) { // to wait all nodes this node depends on
+            *(baseSemaphore + semaphoreCount) = signal;
+            *(baseDstStageMask + semaphoreCount) = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            semaphoreCount++;
         }
 
-        assert(submitCount_ < gfxFutures_.size());
-        gfxFutures_[submitCount_++] = future;
-    } // gfx nodes
+        auto const inputFrameBufferIndex = inputNode.get().frameBufferIndex();
+        for (auto i = size_t{ 0 }; i < value_cast(RenderTargetOutputSemantic::COUNT); i++) {
+            auto const& rt =
+              inputNode.isSurfaceNode()
+                ? static_cast<BaseRenderTarget const&>((*inputNode).getRenderTarget<SurfaceRenderTarget>())
+                : static_cast<BaseRenderTarget const&>((*inputNode).getRenderTarget<FrameBufferRenderTarget>());
 
-    // submits everything and swap buffers
-    endFrame(device, fence);
+            auto semantic = semantics[i];
+
+            if (semantic != RenderTargetOutputSemantic::INVALID) {
+                auto& view = views[i];
+                auto const& attachment = rt.getColorAttachment(inputFrameBufferIndex, semantic);
+
+                if (view != attachment.handle()) {
+                    view = attachment.handle();
+                    node.makeDescriptorSetExpired();
+                }
+            }
+        } // input semantics
+    }     // all inputs
+
+    co_await multithreading::toWorkers();
+
+    // it has to be safe, the graph runs the node after all of its dependencies
+    node.update(semaphoreCount, frameNumber_, frameDeltaTime_);
+
+    // writes own submit info only
+    node.end(semaphoreCount);
 }
 
 auto Workspace::syncFrame(vulkan::Device& device) -> VkFence
@@ -181,6 +169,8 @@ auto Workspace::syncFrame(vulkan::Device& device) -> VkFence
                           nodeCount = graphicsNodeCount_,
                           frameNumber = frameNumber_,
                           &device]() -> VkFence {
+        CYCLONITE_ZONE_ARG("Workspace::syncFrame", frameNumber);
+
         auto vkFence = VkFence{ VK_NULL_HANDLE };
         auto fenceIdx = std::numeric_limits<size_t>::max();
 
@@ -212,20 +202,23 @@ auto Workspace::syncFrame(vulkan::Device& device) -> VkFence
         return vkFence;
     };
 
-    auto future = multithreading::Worker::threadWorker().taskManager().submitRenderTask(frameSyncTask);
-    return future.get();
+    auto& worker = multithreading::Worker::threadWorker();
+    return worker.waitFor(worker.taskManager().submitRenderTask(frameSyncTask));
 }
 
 void Workspace::beginFrame()
 {
     submitCount_ = 0;
+
+    // scratch memory of the last frame is not needed anymore
+    multithreading::Worker::threadWorker().taskManager().beginFrame();
 }
 
 void Workspace::endFrame(vulkan::Device& device, VkFence fence)
 {
-    for (auto i = size_t{ 0 }; i < submitCount_; i++) {
-        gfxFutures_[i].get();
-        submits_[i] = graphicsNodes_[i].get().submitInfo();
+    for (auto gni = uint8_t{ 0 }; gni < graphicsNodeCount_; gni++) {
+        assert(submitCount_ < submits_.size());
+        submits_[submitCount_++] = graphicsNodes_[gni].get().submitInfo();
     }
 
     auto endFrameTask = [&device,
@@ -234,6 +227,8 @@ void Workspace::endFrame(vulkan::Device& device, VkFence fence)
                          submitCount = submitCount_,
                          graphicsNodeCount = graphicsNodeCount_,
                          fence]() -> void {
+        CYCLONITE_ZONE("Workspace::endFrame");
+
         if (auto result = vkQueueSubmit(device.graphicsQueue(), submitCount, submits.data(), fence);
             result != VK_SUCCESS) {
             throw std::runtime_error{ "submit commands failed" };
@@ -242,7 +237,6 @@ void Workspace::endFrame(vulkan::Device& device, VkFence fence)
         for (auto gni = uint8_t{ 0 }; gni < graphicsNodeCount; gni++) {
             auto& node = graphicsNodes[gni];
             node.get().swapBuffers(device);
-            node.get().clearDependencies();
         }
     };
 
@@ -250,8 +244,8 @@ void Workspace::endFrame(vulkan::Device& device, VkFence fence)
         endFrameTask();
     } else {
         assert(multithreading::Worker::isInWorkerThread());
-        auto future = multithreading::Worker::threadWorker().taskManager().submitRenderTask(endFrameTask);
-        future.get();
+        auto& worker = multithreading::Worker::threadWorker();
+        worker.waitFor(worker.taskManager().submitRenderTask(endFrameTask));
     }
 
     frameNumber_++;
@@ -11,7 +11,10 @@
 #include "logicNode.h"
 #include "logicNodeBuilder.h"
 #include "logicNodeInterface.h"
+#include "multithreading/coroutine.h"
+#include "multithreading/taskGraph.h"
 #include "nodeTypeRegister.h"
+#include <memory>
 
 namespace cyclonite::compositor {
 template<NodeConfig Config>
@@ -113,6 +116,12 @@ private:
 
     auto syncFrame(vulkan::Device& device) -> VkFence;
 
+    // logic nodes, then the frame sync, then graphics nodes, edges come from node dependencies
+    void _buildFrameGraph(vulkan::Device& device);
+
+    // suspends while the render thread begins the node, so the worker is free meanwhile
+    auto _updateGraphicsNode(vulkan::Device& device, uint8_t index) -> multithreading::Coroutine<>;
+
 private:
     uint8_t logicNodeCount_;
     std::vector<std::byte> logicNodeStorage_;
@@ -129,10 +138,14 @@ private:
     uint64_t frameNumber_;
 
     std::vector<VkSubmitInfo> submits_;
-    std::vector<std::shared_future<void>> gfxFutures_;
 
     uint32_t submitCount_;
 
+    // built on the first frame, graph nodes refer to the workspace, so it must not be moved after that
+    std::unique_ptr<multithreading::TaskGraph> frameGraph_;
+    real frameDeltaTime_;
+    VkFence frameFence_;
+
     std::vector<vulkan::Handle<VkFence>> frameFences_;
 
     std::chrono::time_point<std::chrono::high_resolution_clock> lastTimeUpdate_;
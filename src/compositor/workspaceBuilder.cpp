@@ -163,7 +163,6 @@ auto Workspace::Builder::build() -> Workspace
     }
 
     workspace.submits_.resize(static_cast<size_t>(graphicNodeCount_), VkSubmitInfo{});
-    workspace.gfxFutures_.resize(static_cast<size_t>(graphicNodeCount_));
 
     return workspace;
 }
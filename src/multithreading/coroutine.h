@@ -0,0 +1,421 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_COROUTINE_H
+#define CYCLONITE_COROUTINE_H
+
+#include "render.h"
+#include "worker.h"
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+namespace cyclonite::multithreading {
+template<typename T>
+class Coroutine;
+
+namespace internal {
+// resumes the coroutine from the queue of the current thread, so any idle worker can pick it up
+inline void scheduleResume(std::coroutine_handle<> handle)
+{
+    if (Render::isInRenderThread()) {
+        Render::renderThread().submitDetachedTask([handle]() -> void { handle.resume(); });
+    } else {
+        assert(Worker::isInWorkerThread());
+        Worker::threadWorker().submitDetachedTask([handle]() -> void { handle.resume(); });
+    }
+}
+
+class CoroutinePromiseBase
+{
+public:
+    struct final_awaiter_t
+    {
+        [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+
+        template<typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) noexcept -> std::coroutine_handle<>
+        {
+            auto& promise = handle.promise();
+
+            // the frame could be destroyed by the waiting thread as soon as it is done,
+            // so only locals are touched after that
+            auto continuation = promise.continuation_;
+            auto* latch = promise.latch_;
+
+            promise.done_.store(true, std::memory_order_release);
+
+            if (latch != nullptr && latch->fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return std::noop_coroutine();
+
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // frames of coroutines started by workers while frames go are in the frame arena,
+    // the arena is not reset until they are destroyed
+    static auto operator new(size_t size) -> void*
+    {
+        auto* arena = Worker::currentFrameArena();
+        auto* memory = arena != nullptr ? arena->acquire(size + header_size_v, alignof(std::max_align_t))
+                                        : ::operator new(size + header_size_v);
+
+        new (memory) FrameArena*{ arena };
+
+        return static_cast<std::byte*>(memory) + header_size_v;
+    }
+
+    static void operator delete(void* ptr, size_t size)
+    {
+        auto* memory = static_cast<std::byte*>(ptr) - header_size_v;
+
+        if (auto* arena = *std::launder(reinterpret_cast<FrameArena**>(memory))) {
+            arena->release();
+        } else {
+            ::operator delete(memory, size + header_size_v);
+        }
+    }
+
+    CoroutinePromiseBase() noexcept
+      : continuation_{}
+      , latch_{ nullptr }
+      , exception_{}
+      , done_{ false }
+    {
+    }
+
+    // coroutines are lazy, they start when somebody awaits them
+    [[nodiscard]] auto initial_suspend() const noexcept -> std::suspend_always { return {}; }
+
+    [[nodiscard]] auto final_suspend() const noexcept -> final_awaiter_t { return {}; }
+
+    void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+    [[nodiscard]] auto done() const -> bool { return done_.load(std::memory_order_acquire); }
+
+    // the continuation is resumed by the coroutine completing the latch
+    void setContinuation(std::coroutine_handle<> continuation, std::atomic<size_t>* latch)
+    {
+        continuation_ = continuation;
+        latch_ = latch;
+    }
+
+    void rethrow() const
+    {
+        if (exception_)
+            std::rethrow_exception(exception_);
+    }
+
+private:
+    // the arena of the coroutine frame (or nullptr) goes before it
+    static constexpr size_t header_size_v = alignof(std::max_align_t);
+
+    std::coroutine_handle<> continuation_;
+    std::atomic<size_t>* latch_;
+    std::exception_ptr exception_;
+    std::atomic<bool> done_;
+};
+
+template<typename T>
+class CoroutinePromise : public CoroutinePromiseBase
+{
+public:
+    auto get_return_object() -> Coroutine<T>;
+
+    template<typename U>
+    void return_value(U&& value)
+    {
+        result_.emplace(std::forward<U>(value));
+    }
+
+    auto result() -> T
+    {
+        rethrow();
+
+        assert(result_);
+        return std::move(*result_);
+    }
+
+private:
+    std::optional<T> result_;
+};
+
+template<>
+class CoroutinePromise<void> : public CoroutinePromiseBase
+{
+public:
+    auto get_return_object() -> Coroutine<void>;
+
+    void return_void() {}
+
+    void result() { rethrow(); }
+};
+
+template<typename... Ts>
+class AllOfAwaiter;
+}
+
+// frame code which suspends instead of blocking the thread,
+// it hops between the render thread and workers with co_await toRenderThread() / co_await toWorkers()
+// awaiting a coroutine starts it and resumes the awaiting one when it is over
+// outside of coroutines Worker::waitFor(coroutine.start()) executes other tasks until it is done
+template<typename T = void>
+class Coroutine
+{
+    template<typename... Ts>
+    friend class internal::AllOfAwaiter;
+
+public:
+    using promise_type = internal::CoroutinePromise<T>;
+
+    Coroutine() noexcept;
+
+    explicit Coroutine(std::coroutine_handle<promise_type> handle) noexcept;
+
+    Coroutine(Coroutine const&) = delete;
+
+    Coroutine(Coroutine&& coroutine) noexcept;
+
+    ~Coroutine();
+
+    auto operator=(Coroutine const&) -> Coroutine& = delete;
+
+    auto operator=(Coroutine&& rhs) noexcept -> Coroutine&;
+
+    [[nodiscard]] auto valid() const -> bool { return static_cast<bool>(handle_); }
+
+    [[nodiscard]] auto ready() const -> bool;
+
+    // runs the coroutine in the current thread until the first suspension
+    auto start() -> Coroutine&;
+
+    // moves the result out
+    auto get() -> T;
+
+    auto operator co_await() noexcept;
+
+private:
+    auto _start(std::coroutine_handle<> continuation, std::atomic<size_t>* latch) -> std::coroutine_handle<>;
+
+    void _destroy();
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+    bool started_;
+};
+
+template<typename T>
+Coroutine<T>::Coroutine() noexcept
+  : handle_{}
+  , started_{ false }
+{
+}
+
+template<typename T>
+Coroutine<T>::Coroutine(std::coroutine_handle<promise_type> handle) noexcept
+  : handle_{ handle }
+  , started_{ false }
+{
+}
+
+template<typename T>
+Coroutine<T>::Coroutine(Coroutine&& coroutine) noexcept
+  : handle_{ std::exchange(coroutine.handle_, nullptr) }
+  , started_{ std::exchange(coroutine.started_, false) }
+{
+}
+
+template<typename T>
+Coroutine<T>::~Coroutine()
+{
+    _destroy();
+}
+
+template<typename T>
+auto Coroutine<T>::operator=(Coroutine&& rhs) noexcept -> Coroutine&
+{
+    if (this != &rhs) {
+        _destroy();
+
+        handle_ = std::exchange(rhs.handle_, nullptr);
+        started_ = std::exchange(rhs.started_, false);
+    }
+
+    return *this;
+}
+
+template<typename T>
+auto Coroutine<T>::ready() const -> bool
+{
+    assert(valid());
+    return handle_.promise().done();
+}
+
+template<typename T>
+auto Coroutine<T>::start() -> Coroutine&
+{
+    _start(std::noop_coroutine(), nullptr).resume();
+    return *this;
+}
+
+template<typename T>
+auto Coroutine<T>::get() -> T
+{
+    assert(ready());
+    return handle_.promise().result();
+}
+
+template<typename T>
+auto Coroutine<T>::operator co_await() noexcept
+{
+    struct awaiter_t
+    {
+        Coroutine* coroutine;
+
+        [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+
+        // symmetric transfer, the awaiting coroutine is resumed by the final suspension of this one
+        auto await_suspend(std::coroutine_handle<> handle) -> std::coroutine_handle<>
+        {
+            return coroutine->_start(handle, nullptr);
+        }
+
+        auto await_resume() -> T { return coroutine->get(); }
+    };
+
+    return awaiter_t{ this };
+}
+
+template<typename T>
+auto Coroutine<T>::_start(std::coroutine_handle<> continuation, std::atomic<size_t>* latch) -> std::coroutine_handle<>
+{
+    assert(valid());
+    assert(!started_);
+
+    started_ = true;
+    handle_.promise().setContinuation(continuation, latch);
+
+    return handle_;
+}
+
+template<typename T>
+void Coroutine<T>::_destroy()
+{
+    if (handle_) {
+        // a suspended coroutine would be resumed later by somebody
+        assert(!started_ || handle_.promise().done());
+
+        std::exchange(handle_, nullptr).destroy();
+    }
+}
+
+namespace internal {
+template<typename T>
+auto CoroutinePromise<T>::get_return_object() -> Coroutine<T>
+{
+    return Coroutine<T>{ std::coroutine_handle<CoroutinePromise<T>>::from_promise(*this) };
+}
+
+inline auto CoroutinePromise<void>::get_return_object() -> Coroutine<void>
+{
+    return Coroutine<void>{ std::coroutine_handle<CoroutinePromise<void>>::from_promise(*this) };
+}
+
+struct RenderThreadAwaiter
+{
+    [[nodiscard]] auto await_ready() const noexcept -> bool { return Render::isInRenderThread(); }
+
+    void await_suspend(std::coroutine_handle<> handle) const
+    {
+        Worker::threadWorker().submitDetachedRenderTask([handle]() -> void { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct WorkersAwaiter
+{
+    [[nodiscard]] auto await_ready() const noexcept -> bool { return Worker::isInWorkerThread(); }
+
+    void await_suspend(std::coroutine_handle<> handle) const
+    {
+        Render::renderThread().submitDetachedTask([handle]() -> void { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+};
+
+// all coroutines but the last one are offered to thieves, the last one starts in place,
+// the latch holds one more count until everything is started
+template<typename... Ts>
+class AllOfAwaiter
+{
+public:
+    explicit AllOfAwaiter(Coroutine<Ts>&... coroutines) noexcept
+      : coroutines_{ &coroutines... }
+      , latch_{ sizeof...(Ts) + 1 }
+    {
+    }
+
+    [[nodiscard]] auto await_ready() const noexcept -> bool { return sizeof...(Ts) == 0; }
+
+    auto await_suspend(std::coroutine_handle<> handle) -> bool
+    {
+        auto last = std::coroutine_handle<>{};
+
+        auto start = [this, handle, &last](auto* coroutine) -> void {
+            if (last)
+                scheduleResume(last);
+
+            last = coroutine->_start(handle, &latch_);
+        };
+
+        std::apply([&start](auto*... coroutine) -> void { (start(coroutine), ...); }, coroutines_);
+
+        last.resume();
+
+        // false resumes the awaiting coroutine right away
+        return latch_.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+
+    // the first failure
+    void await_resume() const
+    {
+        std::apply([](auto*... coroutine) -> void { (coroutine->handle_.promise().rethrow(), ...); }, coroutines_);
+    }
+
+private:
+    std::tuple<Coroutine<Ts>*...> coroutines_;
+    std::atomic<size_t> latch_;
+};
+}
+
+// resumes the coroutine in the render thread
+[[nodiscard]] inline auto toRenderThread() -> internal::RenderThreadAwaiter
+{
+    return internal::RenderThreadAwaiter{};
+}
+
+// resumes the coroutine in a worker thread, the render thread hands it over through its own queue
+[[nodiscard]] inline auto toWorkers() -> internal::WorkersAwaiter
+{
+    return internal::WorkersAwaiter{};
+}
+
+// resumes the awaiting coroutine when all of the coroutines are over, results are taken by get()
+template<typename... Ts>
+[[nodiscard]] auto allOf(Coroutine<Ts>&... coroutines) -> internal::AllOfAwaiter<Ts...>
+{
+    return internal::AllOfAwaiter<Ts...>{ coroutines... };
+}
+}
+
+#endif // CYCLONITE_COROUTINE_H
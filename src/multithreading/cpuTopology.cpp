@@ -0,0 +1,214 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "cpuTopology.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace cyclonite::multithreading {
+static constexpr auto _maxCapacity = uint32_t{ 1024 };
+
+// e-cores of intel hybrid cpus do not report their capacity, they get a half of the p-core one
+static constexpr auto _efficiencyCoreCapacity = uint32_t{ 512 };
+
+CpuTopology::CpuTopology(std::vector<LogicalCpu> cpus)
+  : cpus_{ std::move(cpus) }
+  , physicalCoreCount_{ 0 }
+  , packageCount_{ 0 }
+  , hybrid_{ false }
+{
+    auto cores = std::set<uint32_t>{};
+    auto packages = std::set<uint32_t>{};
+
+    for (auto&& cpu : cpus_) {
+        cores.insert(cpu.core);
+        packages.insert(cpu.package);
+
+        hybrid_ = hybrid_ || cpu.capacity != cpus_.front().capacity;
+    }
+
+    physicalCoreCount_ = cores.size();
+    packageCount_ = packages.size();
+}
+
+auto parseCpuList(std::string_view list) -> std::vector<uint32_t>
+{
+    auto cpus = std::vector<uint32_t>{};
+
+    auto parse = [](std::string_view number) -> std::optional<uint32_t> {
+        auto value = uint32_t{ 0 };
+        auto [end, error] = std::from_chars(number.data(), number.data() + number.size(), value);
+
+        if (error != std::errc{} || end != number.data() + number.size())
+            return std::nullopt;
+
+        return value;
+    };
+
+    while (!list.empty()) {
+        auto comma = list.find(',');
+        auto range = list.substr(0, comma);
+
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+        while (!range.empty() && std::isspace(static_cast<unsigned char>(range.front())))
+            range.remove_prefix(1);
+
+        while (!range.empty() && std::isspace(static_cast<unsigned char>(range.back())))
+            range.remove_suffix(1);
+
+        if (range.empty())
+            continue;
+
+        auto dash = range.find('-');
+        auto first = parse(range.substr(0, dash));
+        auto last = dash == std::string_view::npos ? first : parse(range.substr(dash + 1));
+
+        if (!first || !last || *first > *last)
+            continue;
+
+        for (auto cpu = *first; cpu <= *last; cpu++)
+            cpus.push_back(cpu);
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+    return cpus;
+}
+
+#if defined(__linux__)
+static auto _readLine(std::string const& path) -> std::optional<std::string>
+{
+    auto file = std::ifstream{ path };
+    auto line = std::string{};
+
+    if (!file || !std::getline(file, line))
+        return std::nullopt;
+
+    return line;
+}
+
+static auto _readNumber(std::string const& path) -> std::optional<uint32_t>
+{
+    auto line = _readLine(path);
+
+    if (!line)
+        return std::nullopt;
+
+    auto value = uint32_t{ 0 };
+    auto [end, error] = std::from_chars(line->data(), line->data() + line->size(), value);
+
+    return error == std::errc{} ? std::optional{ value } : std::nullopt;
+}
+
+auto CpuTopology::detect() -> CpuTopology
+{
+    auto const root = std::string{ "/sys/devices/system/cpu/" };
+
+    auto online = parseCpuList(_readLine(root + "online").value_or(std::string{}));
+
+    if (online.empty()) {
+        for (auto i = uint32_t{ 0 }, count = std::max(std::thread::hardware_concurrency(), 1u); i < count; i++)
+            online.push_back(i);
+    }
+
+    auto efficiencyCores = parseCpuList(_readLine("/sys/devices/cpu_atom/cpus").value_or(std::string{}));
+
+    auto affinity = cpu_set_t{};
+    CPU_ZERO(&affinity);
+
+    auto const hasAffinity = sched_getaffinity(0, sizeof(affinity), &affinity) == 0;
+
+    // core ids repeat over packages
+    auto coreIndices = std::map<std::pair<uint32_t, uint32_t>, uint32_t>{};
+    auto cpus = std::vector<LogicalCpu>{};
+
+    cpus.reserve(online.size());
+
+    for (auto id : online) {
+        auto const topology = root + "cpu" + std::to_string(id) + "/topology/";
+
+        auto package = _readNumber(topology + "physical_package_id").value_or(0);
+        auto coreId = _readNumber(topology + "core_id").value_or(id);
+        auto siblings = parseCpuList(_readLine(topology + "thread_siblings_list").value_or(std::string{}));
+
+        auto core = coreIndices.emplace(std::make_pair(package, coreId), static_cast<uint32_t>(coreIndices.size()))
+                      .first->second;
+
+        auto capacity = _readNumber(root + "cpu" + std::to_string(id) + "/cpu_capacity");
+
+        if (!capacity) {
+            capacity = std::binary_search(efficiencyCores.begin(), efficiencyCores.end(), id) ? _efficiencyCoreCapacity
+                                                                                               : _maxCapacity;
+        }
+
+        cpus.push_back(LogicalCpu{ id,
+                                   core,
+                                   package,
+                                   *capacity,
+                                   siblings.empty() || siblings.front() == id,
+                                   !hasAffinity || CPU_ISSET(id, &affinity) });
+    }
+
+    return CpuTopology{ std::move(cpus) };
+}
+
+static auto _setAffinity(pthread_t thread, std::span<uint32_t const> cpus) -> bool
+{
+    auto set = cpu_set_t{};
+    CPU_ZERO(&set);
+
+    for (auto cpu : cpus) {
+        if (cpu >= CPU_SETSIZE)
+            return false;
+
+        CPU_SET(cpu, &set);
+    }
+
+    return !cpus.empty() && pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+auto setThreadAffinity(std::thread& thread, std::span<uint32_t const> cpus) -> bool
+{
+    return _setAffinity(thread.native_handle(), cpus);
+}
+
+auto setCurrentThreadAffinity(std::span<uint32_t const> cpus) -> bool
+{
+    return _setAffinity(pthread_self(), cpus);
+}
+#else
+auto CpuTopology::detect() -> CpuTopology
+{
+    auto cpus = std::vector<LogicalCpu>{};
+
+    for (auto i = uint32_t{ 0 }, count = std::max(std::thread::hardware_concurrency(), 1u); i < count; i++)
+        cpus.push_back(LogicalCpu{ i, i, 0, _maxCapacity, true, true });
+
+    return CpuTopology{ std::move(cpus) };
+}
+
+auto setThreadAffinity(std::thread&, std::span<uint32_t const>) -> bool
+{
+    return false;
+}
+
+auto setCurrentThreadAffinity(std::span<uint32_t const>) -> bool
+{
+    return false;
+}
+#endif
+}
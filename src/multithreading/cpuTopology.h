@@ -0,0 +1,59 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_CPUTOPOLOGY_H
+#define CYCLONITE_CPUTOPOLOGY_H
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace cyclonite::multithreading {
+struct LogicalCpu
+{
+    uint32_t id;       // the os index of the cpu
+    uint32_t core;     // physical core, unique over packages
+    uint32_t package;  // socket
+    uint32_t capacity; // relative performance, 1024 for the fastest cores (hybrid cpus have lower ones)
+    bool primary;      // the first hardware thread of the core, the others are its smt siblings
+    bool allowed;      // the process affinity mask contains it
+};
+
+// logical cpus of the machine, read from /sys on linux,
+// elsewhere every hardware thread looks like a core of its own
+class CpuTopology
+{
+public:
+    explicit CpuTopology(std::vector<LogicalCpu> cpus);
+
+    static auto detect() -> CpuTopology;
+
+    [[nodiscard]] auto cpus() const -> std::vector<LogicalCpu> const& { return cpus_; }
+
+    [[nodiscard]] auto physicalCoreCount() const -> size_t { return physicalCoreCount_; }
+
+    [[nodiscard]] auto packageCount() const -> size_t { return packageCount_; }
+
+    // cores of different performance, like p- and e-cores
+    [[nodiscard]] auto hybrid() const -> bool { return hybrid_; }
+
+private:
+    std::vector<LogicalCpu> cpus_;
+    size_t physicalCoreCount_;
+    size_t packageCount_;
+    bool hybrid_;
+};
+
+// "0-3,8,10-11" -> { 0, 1, 2, 3, 8, 10, 11 }, the format of cpu lists in /sys
+auto parseCpuList(std::string_view list) -> std::vector<uint32_t>;
+
+// the thread runs only on the cpus, false if the platform does not support affinity or none of the cpus is allowed
+auto setThreadAffinity(std::thread& thread, std::span<uint32_t const> cpus) -> bool;
+
+auto setCurrentThreadAffinity(std::span<uint32_t const> cpus) -> bool;
+}
+
+#endif // CYCLONITE_CPUTOPOLOGY_H
@@ -0,0 +1,103 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "frameArena.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+namespace cyclonite::multithreading {
+FrameArena::FrameArena(size_t chunkSize) noexcept
+  : chunks_{}
+  , cursor_{ nullptr }
+  , end_{ nullptr }
+  , chunkSize_{ chunkSize }
+  , capacity_{ 0 }
+  , spilled_{ 0 }
+  , alive_{ 0 }
+{
+    assert(chunkSize_ > 0);
+}
+
+FrameArena::~FrameArena()
+{
+    // somebody still refers to the memory
+    assert(aliveCount() == 0);
+}
+
+auto FrameArena::allocate(size_t size, size_t alignment) -> void*
+{
+    assert(std::has_single_bit(alignment));
+
+    auto align = [alignment](std::byte* ptr) -> uintptr_t {
+        return (reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(alignment - 1);
+    };
+
+    auto address = align(cursor_);
+
+    if (cursor_ == nullptr || address + size > reinterpret_cast<uintptr_t>(end_)) {
+        _grow(size + alignment);
+        address = align(cursor_);
+    }
+
+    cursor_ = reinterpret_cast<std::byte*>(address + size);
+
+    return reinterpret_cast<void*>(address);
+}
+
+auto FrameArena::acquire(size_t size, size_t alignment) -> void*
+{
+    auto* ptr = allocate(size, alignment);
+
+    alive_.fetch_add(1, std::memory_order_relaxed);
+
+    return ptr;
+}
+
+auto FrameArena::reset() -> bool
+{
+    // the acquired memory could be still in use by other threads
+    if (alive_.load(std::memory_order_acquire) != 0)
+        return false;
+
+    if (chunks_.empty())
+        return true;
+
+    // the frame did not fit one chunk, the next one gets a chunk for all of it
+    if (chunks_.size() > 1) {
+        auto size = std::bit_ceil(capacity_);
+
+        chunks_.clear();
+        capacity_ = 0;
+
+        _grow(size);
+    }
+
+    cursor_ = chunks_.back().memory.get();
+    end_ = cursor_ + chunks_.back().size;
+    spilled_ = 0;
+
+    return true;
+}
+
+auto FrameArena::used() const -> size_t
+{
+    return chunks_.empty() ? 0 : spilled_ + static_cast<size_t>(cursor_ - chunks_.back().memory.get());
+}
+
+void FrameArena::_grow(size_t size)
+{
+    if (!chunks_.empty())
+        spilled_ += static_cast<size_t>(cursor_ - chunks_.back().memory.get());
+
+    size = std::max({ size, chunkSize_, chunks_.empty() ? size_t{ 0 } : chunks_.back().size * 2 });
+
+    chunks_.push_back(chunk_t{ std::make_unique_for_overwrite<std::byte[]>(size), size });
+    capacity_ += size;
+
+    cursor_ = chunks_.back().memory.get();
+    end_ = cursor_ + size;
+}
+}
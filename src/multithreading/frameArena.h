@@ -0,0 +1,118 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_FRAMEARENA_H
+#define CYCLONITE_FRAMEARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace cyclonite::multithreading {
+// linear allocator for the transient data of a frame, only the owner thread allocates,
+// nothing is freed until reset, after a few frames one chunk holds a whole frame and nothing is allocated at all
+class FrameArena
+{
+public:
+    static constexpr size_t default_chunk_size_v = 64 * 1024;
+
+    explicit FrameArena(size_t chunkSize = default_chunk_size_v) noexcept;
+
+    FrameArena(FrameArena const&) = delete;
+
+    FrameArena(FrameArena&&) = delete;
+
+    ~FrameArena();
+
+    auto operator=(FrameArena const&) -> FrameArena& = delete;
+
+    auto operator=(FrameArena&&) -> FrameArena& = delete;
+
+    auto allocate(size_t size, size_t alignment) -> void*;
+
+    // the allocation keeps the arena from reset until it is released, from any thread
+    auto acquire(size_t size, size_t alignment) -> void*;
+
+    void release() { alive_.fetch_sub(1, std::memory_order_release); }
+
+    // drops all of the allocations, false (and nothing happens) while acquired ones are alive
+    auto reset() -> bool;
+
+    [[nodiscard]] auto used() const -> size_t;
+
+    [[nodiscard]] auto capacity() const -> size_t { return capacity_; }
+
+    [[nodiscard]] auto chunkCount() const -> size_t { return chunks_.size(); }
+
+    [[nodiscard]] auto aliveCount() const -> size_t { return alive_.load(std::memory_order_relaxed); }
+
+private:
+    struct chunk_t
+    {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    void _grow(size_t size);
+
+private:
+    std::vector<chunk_t> chunks_;
+    std::byte* cursor_;
+    std::byte* end_;
+    size_t chunkSize_;
+    size_t capacity_;
+    size_t spilled_; // used bytes of the chunks before the current one
+    std::atomic<size_t> alive_;
+};
+
+// std allocator over a frame arena, deallocation does nothing,
+// containers must not outlive the frame (e.g. multithreading::frame_vector_t<int>{ worker.frameArena() })
+template<typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    // implicit, so a container can be made right from the arena
+    explicit(false) FrameAllocator(FrameArena& arena) noexcept
+      : arena_{ &arena }
+    {
+    }
+
+    template<typename U>
+    explicit(false) FrameAllocator(FrameAllocator<U> const& allocator) noexcept
+      : arena_{ allocator.arena() }
+    {
+    }
+
+    [[nodiscard]] auto allocate(size_t n) -> T*
+    {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_array_new_length{};
+
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    [[nodiscard]] auto arena() const -> FrameArena* { return arena_; }
+
+    template<typename U>
+    auto operator==(FrameAllocator<U> const& rhs) const noexcept -> bool
+    {
+        return arena_ == rhs.arena();
+    }
+
+private:
+    FrameArena* arena_;
+};
+
+template<typename T>
+using frame_vector_t = std::vector<T, FrameAllocator<T>>;
+}
+
+#endif // CYCLONITE_FRAMEARENA_H
@@ -0,0 +1,271 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_FUTURE_H
+#define CYCLONITE_FUTURE_H
+
+#include "task.h"
+#include "taskPool.h"
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace cyclonite::multithreading {
+class Worker;
+class TaskManager;
+
+// the result of the pooled task, the shared state is the task slot itself
+// the slot goes back to the pool when both the task is executed and the future is released
+template<typename T>
+class Future
+{
+    friend class Worker;
+    friend class TaskManager;
+
+    template<typename U>
+    friend class SharedFuture;
+
+public:
+    Future() noexcept;
+
+    Future(Future const&) = delete;
+
+    Future(Future&& future) noexcept;
+
+    ~Future();
+
+    auto operator=(Future const&) -> Future& = delete;
+
+    auto operator=(Future&& rhs) noexcept -> Future&;
+
+    [[nodiscard]] auto valid() const -> bool { return task_ != nullptr; }
+
+    [[nodiscard]] auto ready() const -> bool;
+
+    void wait() const;
+
+    // moves the result out and releases the task, the future is not valid after that
+    auto get() -> T;
+
+    auto share() -> SharedFuture<T>;
+
+private:
+    explicit Future(Task* task) noexcept;
+
+    void _release();
+
+private:
+    Task* task_;
+};
+
+template<typename T>
+class SharedFuture
+{
+public:
+    using const_reference_t = std::conditional_t<std::is_void_v<T>, void, std::add_lvalue_reference_t<T const>>;
+
+    SharedFuture() noexcept;
+
+    SharedFuture(Future<T>&& future) noexcept;
+
+    SharedFuture(SharedFuture const& future) noexcept;
+
+    SharedFuture(SharedFuture&& future) noexcept;
+
+    ~SharedFuture();
+
+    auto operator=(SharedFuture const& rhs) noexcept -> SharedFuture&;
+
+    auto operator=(SharedFuture&& rhs) noexcept -> SharedFuture&;
+
+    [[nodiscard]] auto valid() const -> bool { return task_ != nullptr; }
+
+    [[nodiscard]] auto ready() const -> bool;
+
+    void wait() const;
+
+    auto get() const -> const_reference_t;
+
+private:
+    void _release();
+
+private:
+    Task* task_;
+};
+
+template<typename T>
+Future<T>::Future() noexcept
+  : task_{ nullptr }
+{
+}
+
+template<typename T>
+Future<T>::Future(Task* task) noexcept
+  : task_{ task }
+{
+    assert(task_ != nullptr);
+    task_->_attachFuture();
+}
+
+template<typename T>
+Future<T>::Future(Future&& future) noexcept
+  : task_{ std::exchange(future.task_, nullptr) }
+{
+}
+
+template<typename T>
+Future<T>::~Future()
+{
+    _release();
+}
+
+template<typename T>
+auto Future<T>::operator=(Future&& rhs) noexcept -> Future&
+{
+    if (this != &rhs) {
+        _release();
+        task_ = std::exchange(rhs.task_, nullptr);
+    }
+
+    return *this;
+}
+
+template<typename T>
+auto Future<T>::ready() const -> bool
+{
+    assert(valid());
+    return task_->ready();
+}
+
+template<typename T>
+void Future<T>::wait() const
+{
+    assert(valid());
+    task_->_wait();
+}
+
+template<typename T>
+auto Future<T>::get() -> T
+{
+    wait();
+
+    // releases the task even if the result is an exception
+    auto task = std::unique_ptr<Task, void (*)(Task*)>{ std::exchange(task_, nullptr), &TaskPool::release };
+
+    task->_rethrow();
+
+    if constexpr (std::is_reference_v<T>) {
+        return task->template _result<T>();
+    } else if constexpr (!std::is_void_v<T>) {
+        return std::move(task->template _result<T>());
+    }
+}
+
+template<typename T>
+auto Future<T>::share() -> SharedFuture<T>
+{
+    assert(valid());
+
+    return SharedFuture<T>{ std::move(*this) };
+}
+
+template<typename T>
+void Future<T>::_release()
+{
+    if (task_ != nullptr)
+        TaskPool::release(std::exchange(task_, nullptr));
+}
+
+template<typename T>
+SharedFuture<T>::SharedFuture() noexcept
+  : task_{ nullptr }
+{
+}
+
+template<typename T>
+SharedFuture<T>::SharedFuture(Future<T>&& future) noexcept
+  : task_{ std::exchange(future.task_, nullptr) }
+{
+}
+
+template<typename T>
+SharedFuture<T>::SharedFuture(SharedFuture const& future) noexcept
+  : task_{ future.task_ }
+{
+    if (task_ != nullptr)
+        task_->_retain();
+}
+
+template<typename T>
+SharedFuture<T>::SharedFuture(SharedFuture&& future) noexcept
+  : task_{ std::exchange(future.task_, nullptr) }
+{
+}
+
+template<typename T>
+SharedFuture<T>::~SharedFuture()
+{
+    _release();
+}
+
+template<typename T>
+auto SharedFuture<T>::operator=(SharedFuture const& rhs) noexcept -> SharedFuture&
+{
+    if (this != &rhs) {
+        if (rhs.task_ != nullptr)
+            rhs.task_->_retain();
+
+        _release();
+        task_ = rhs.task_;
+    }
+
+    return *this;
+}
+
+template<typename T>
+auto SharedFuture<T>::operator=(SharedFuture&& rhs) noexcept -> SharedFuture&
+{
+    if (this != &rhs) {
+        _release();
+        task_ = std::exchange(rhs.task_, nullptr);
+    }
+
+    return *this;
+}
+
+template<typename T>
+auto SharedFuture<T>::ready() const -> bool
+{
+    assert(valid());
+    return task_->ready();
+}
+
+template<typename T>
+void SharedFuture<T>::wait() const
+{
+    assert(valid());
+    task_->_wait();
+}
+
+template<typename T>
+auto SharedFuture<T>::get() const -> const_reference_t
+{
+    wait();
+
+    task_->_rethrow();
+
+    if constexpr (!std::is_void_v<T>) {
+        return task_->template _result<T>();
+    }
+}
+
+template<typename T>
+void SharedFuture<T>::_release()
+{
+    if (task_ != nullptr)
+        TaskPool::release(std::exchange(task_, nullptr));
+}
+}
+
+#endif // CYCLONITE_FUTURE_H
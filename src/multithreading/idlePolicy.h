@@ -0,0 +1,127 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_IDLEPOLICY_H
+#define CYCLONITE_IDLEPOLICY_H
+
+#include "parkingLot.h"
+#include "schedulerMetrics.h"
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace cyclonite::multithreading {
+enum class IdleStrategy : uint8_t
+{
+    SPIN = 0,           // yields forever, the lowest wake up latency, but every idle thread keeps its core busy
+    SPIN_THEN_PARK = 1, // yields for the bounded time, then sleeps until a new task is submitted
+    MIN_VALUE = SPIN,
+    MAX_VALUE = SPIN_THEN_PARK,
+    COUNT = MAX_VALUE + 1
+};
+
+class IdlePolicy
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    constexpr explicit IdlePolicy(IdleStrategy strategy = IdleStrategy::SPIN_THEN_PARK,
+                                  std::chrono::microseconds spinTime = std::chrono::microseconds{ 200 }) noexcept
+      : strategy_{ strategy }
+      , spinTime_{ spinTime }
+    {
+    }
+
+    [[nodiscard]] auto strategy() const -> IdleStrategy { return strategy_; }
+
+    [[nodiscard]] auto spinTime() const -> std::chrono::microseconds { return spinTime_; }
+
+    [[nodiscard]] auto canPark() const -> bool { return strategy_ == IdleStrategy::SPIN_THEN_PARK; }
+
+private:
+    IdleStrategy strategy_;
+    std::chrono::microseconds spinTime_;
+};
+
+// per thread idle state, spins while the spin time is not over, parks after that,
+// idle time goes to the counter on every call (so a parked thread reports it when it wakes up)
+class Idler
+{
+public:
+    Idler(IdlePolicy const& policy, ParkingLot& parkingLot, internal::MetricCounter* idleNanoseconds = nullptr) noexcept
+      : policy_{ policy }
+      , parkingLot_{ &parkingLot }
+      , idleNanoseconds_{ idleNanoseconds }
+      , idle_{ false }
+      , spinning_{ false }
+      , idleTick_{}
+      , spinStart_{}
+    {
+    }
+
+    void reset();
+
+    template<typename Predicate>
+    void idle(Predicate&& hasWork);
+
+private:
+    void _countIdleTime(IdlePolicy::clock_t::time_point now);
+
+    IdlePolicy policy_;
+    ParkingLot* parkingLot_;
+    internal::MetricCounter* idleNanoseconds_;
+    bool idle_;
+    bool spinning_;
+    IdlePolicy::clock_t::time_point idleTick_;
+    IdlePolicy::clock_t::time_point spinStart_;
+};
+
+inline void Idler::reset()
+{
+    spinning_ = false;
+
+    if (!idle_)
+        return;
+
+    idle_ = false;
+    _countIdleTime(IdlePolicy::clock_t::now());
+}
+
+inline void Idler::_countIdleTime(IdlePolicy::clock_t::time_point now)
+{
+    if (idleNanoseconds_ != nullptr) {
+        auto idleTime = std::chrono::duration_cast<std::chrono::nanoseconds>(now - idleTick_);
+        idleNanoseconds_->add(static_cast<uint64_t>(idleTime.count()));
+    }
+
+    idleTick_ = now;
+}
+
+template<typename Predicate>
+void Idler::idle(Predicate&& hasWork)
+{
+    auto now = IdlePolicy::clock_t::now();
+
+    if (idle_) {
+        _countIdleTime(now);
+    } else {
+        idle_ = true;
+        idleTick_ = now;
+    }
+
+    if (!spinning_) {
+        spinning_ = true;
+        spinStart_ = now;
+    }
+
+    if (policy_.canPark() && now - spinStart_ >= policy_.spinTime()) {
+        parkingLot_->park(std::forward<Predicate>(hasWork));
+        spinning_ = false;
+    } else {
+        std::this_thread::yield();
+    }
+}
+}
+
+#endif // CYCLONITE_IDLEPOLICY_H
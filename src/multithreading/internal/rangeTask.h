@@ -0,0 +1,121 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_MULTITHREADING_RANGETASK_H
+#define CYCLONITE_MULTITHREADING_RANGETASK_H
+
+#include "../worker.h"
+#include <array>
+#include <bit>
+#include <concepts>
+#include <exception>
+#include <optional>
+
+namespace cyclonite::multithreading::internal {
+struct no_combine_t
+{};
+
+// lazy binary splitting, the task gives away the second half of its range only while
+// the own queue is empty, i.e. the thieves have already taken everything offered before,
+// so the range gets split as deep as the demand is and the rest is processed by grains serially
+template<std::integral Index, typename Result, typename Body, typename Combine>
+struct RangeTask
+{
+    static constexpr size_t max_split_count_v = 64;
+
+    Index first;
+    Index last;
+    Index grain;
+    uint32_t eagerSplitCount; // splits done without demand, feeds every worker at the start
+    Body* body;
+    Combine* combine;
+
+    auto operator()() const -> Result;
+};
+
+template<std::integral Index, typename Result, typename Body, typename Combine>
+auto RangeTask<Index, Result, Body, Combine>::operator()() const -> Result
+{
+    constexpr bool is_void_v = std::is_void_v<Result>;
+
+    using partial_t = std::conditional_t<is_void_v, bool, Result>;
+
+    auto& worker = Worker::threadWorker();
+    auto children = std::array<Future<Result>, max_split_count_v>{};
+    auto childCount = size_t{ 0 };
+
+    auto result = std::optional<partial_t>{};
+    auto exception = std::exception_ptr{};
+
+    auto accumulate = [this, &result](auto&& partial) -> void {
+        if constexpr (!is_void_v) {
+            result = result ? (*combine)(std::move(*result), std::forward<decltype(partial)>(partial))
+                            : std::forward<decltype(partial)>(partial);
+        }
+    };
+
+    auto process = [this, &accumulate](Index from, Index to) -> void {
+        if constexpr (is_void_v) {
+            (*body)(from, to);
+        } else {
+            accumulate((*body)(from, to));
+        }
+    };
+
+    try {
+        auto from = first;
+        auto to = last;
+        auto eagerSplits = eagerSplitCount;
+
+        while (to - from > grain) {
+            if (childCount < max_split_count_v && (eagerSplits > 0 || worker.pendingTaskCount() == 0)) {
+                eagerSplits = eagerSplits > 0 ? eagerSplits - 1 : 0;
+
+                auto middle = static_cast<Index>(from + (to - from) / 2);
+
+                children[childCount++] = worker.submitTask(RangeTask{ middle, to, grain, eagerSplits, body, combine });
+                to = middle;
+            } else {
+                process(from, static_cast<Index>(from + grain));
+                from = static_cast<Index>(from + grain);
+            }
+        }
+
+        process(from, to);
+    } catch (...) {
+        exception = std::current_exception();
+    }
+
+    // children refer to the body, so all of them must be over before leaving,
+    // the later child holds the earlier part of the range
+    for (auto i = childCount; i-- > 0;) {
+        try {
+            if constexpr (is_void_v) {
+                worker.waitFor(children[i]);
+            } else {
+                accumulate(worker.waitFor(children[i]));
+            }
+        } catch (...) {
+            if (!exception)
+                exception = std::current_exception();
+        }
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+
+    if constexpr (!is_void_v) {
+        assert(result);
+        return std::move(*result);
+    }
+}
+
+inline auto eagerSplitCount(size_t workerCount) -> uint32_t
+{
+    // about two ranges per worker
+    return static_cast<uint32_t>(std::bit_width(workerCount));
+}
+}
+
+#endif // CYCLONITE_MULTITHREADING_RANGETASK_H
@@ -5,19 +5,27 @@
 #ifndef CYCLONITE_MULTITHREADING_UTILS_H
 #define CYCLONITE_MULTITHREADING_UTILS_H
 
-#include <random>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
 
 namespace cyclonite::multithreading::internal {
-static auto randomWorkerIndex(size_t count) -> size_t
+// xorshift32 per thread, it only has to spread thieves over victims
+inline auto randomWorkerIndex(size_t count) -> size_t
 {
     assert(count > 0);
 
-    static thread_local auto rd = std::random_device();
-    static thread_local auto generator = std::mt19937{ rd() };
+    static thread_local auto state =
+      static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | uint32_t{ 1 };
 
-    std::uniform_int_distribution<int> distribution(0, static_cast<int>(count) - 1);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
 
-    return static_cast<size_t>(distribution(generator));
+    // multiply-shift instead of modulo
+    return static_cast<size_t>((static_cast<uint64_t>(state) * count) >> 32);
 }
 }
 
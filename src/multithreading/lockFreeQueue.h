@@ -6,22 +6,33 @@
 #define CYCLONITE_LOCKFREEQUEUE_H
 
 #include "typedefs.h"
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <bit>
-#include <boost/lockfree/queue.hpp>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <new>
 #include <optional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace cyclonite::multithreading {
 // Dynamic Circular Work-Stealing Deque
 // https://www.dre.vanderbilt.edu/~schmidt/PDF/work-stealing-dequeue.pdf
+// slots are relaxed atomics, a thief reads the slot before it claims the item,
+// so the owner could overwrite it meanwhile (see Le et al., Correct and Efficient Work-Stealing for Weak Memory Models)
+// the owner replaces the buffer when it grows or stays mostly empty for a while, the old one is retired
+// and freed two epochs later: a thief registers in the reader counter of the current epoch while it reads a slot,
+// the owner advances the epoch only when the counter of the previous one is drained
 template<typename T>
 class LockFreeSPMCQueue
 {
+    static_assert(std::is_trivially_copyable_v<T>, "items are stored in atomic slots");
+
     class CircularArray
     {
     public:
@@ -29,18 +40,16 @@ class LockFreeSPMCQueue
 
         [[nodiscard]] auto capacity() const -> size_t { return static_cast<size_t>(capacity_); }
 
-        void store(size_t index, T&& t) noexcept
-            requires std::is_nothrow_move_assignable_v<T>;
+        void store(size_t index, T t) noexcept;
 
-        auto load(size_t index) noexcept -> T
-            requires std::is_nothrow_move_constructible_v<T>;
+        auto load(size_t index) const noexcept -> T;
 
-        [[nodiscard]] auto resize(int64_t bottom, int64_t top) -> CircularArray*;
+        [[nodiscard]] auto resize(int64_t bottom, int64_t top, size_t capacity) const -> CircularArray*;
 
     private:
         int64_t capacity_;
         int64_t mask_;
-        std::unique_ptr<T[]> data_;
+        std::unique_ptr<std::atomic<T>[]> data_;
     };
 
 public:
@@ -48,8 +57,14 @@ public:
 
     [[nodiscard]] auto size() const -> size_t;
 
+    // for the owner only, the buffer could be gone for the others
     [[nodiscard]] auto capacity() const -> size_t;
 
+    [[nodiscard]] auto retiredBufferCount() const -> size_t { return garbage_.size(); }
+
+    // the most items the queue has held (as the owner saw it)
+    [[nodiscard]] auto maxSize() const -> size_t { return maxSize_.load(std::memory_order_relaxed); }
+
     [[nodiscard]] auto empty() const -> bool { return size() == 0; }
 
     template<typename... Args>
@@ -57,48 +72,87 @@ public:
 
     auto popBottom() -> std::optional<T>;
 
+    // leaves the item in the queue if the predicate rejects it
+    template<typename Predicate>
+    auto popBottom(Predicate&& accept) -> std::optional<T>;
+
     auto steal() -> std::optional<T>;
 
+    // the predicate may see a stale item, but only the accepted one is claimed
+    template<typename Predicate>
+    auto steal(Predicate&& accept) -> std::optional<T>;
+
+    // steals one item and moves up to a half of the rest (not more than maxCount) to the sink,
+    // every item is claimed by its own CAS on top: the owner pops the bottom without CAS
+    // while it sees more than one item, so a claim of the whole range at once could overlap it
+    template<typename Predicate, typename Sink>
+    auto stealBatch(Predicate&& accept, Sink&& sink, size_t maxCount) -> std::optional<T>;
+
     ~LockFreeSPMCQueue() noexcept;
 
+private:
+    // pops in a row with the queue filled less than a quarter before the buffer shrinks
+    static constexpr uint32_t shrink_delay_v = 4096;
+
+    struct retired_buffer_t
+    {
+        std::unique_ptr<CircularArray> buffer;
+        uint64_t epoch;
+    };
+
+    auto _enterReader() -> std::atomic<int64_t>&;
+
+    void _replaceBuffer(CircularArray* buffer);
+
+    void _collectGarbage();
+
+    void _shrinkIfUnderused(int64_t bottom, int64_t top);
+
 private:
     alignas(hardware_destructive_interference_size) std::atomic<int64_t> top_;
     alignas(hardware_destructive_interference_size) std::atomic<int64_t> bottom_;
     alignas(hardware_destructive_interference_size) std::atomic<CircularArray*> buffer_;
-
-    std::vector<std::unique_ptr<CircularArray>> garbage_;
+    alignas(hardware_destructive_interference_size) std::atomic<uint64_t> epoch_;
+    std::array<std::atomic<int64_t>, 2> readers_;
+
+    // owner only
+    alignas(hardware_destructive_interference_size) std::vector<retired_buffer_t> garbage_;
+    size_t minCapacity_;
+    uint32_t underuseCount_;
+    std::atomic<size_t> maxSize_;
 };
 
 template<typename T>
 LockFreeSPMCQueue<T>::CircularArray::CircularArray(size_t capacity)
   : capacity_{ static_cast<int64_t>(capacity) }
   , mask_{ static_cast<int64_t>(capacity) - 1 }
-  , data_{ std::make_unique_for_overwrite<T[]>(capacity) }
+  , data_{ std::make_unique_for_overwrite<std::atomic<T>[]>(capacity) }
 {
     assert(capacity > 0);
     assert(std::has_single_bit(capacity));
 }
 
 template<typename T>
-void LockFreeSPMCQueue<T>::CircularArray::store(size_t index, T&& t) noexcept
-    requires std::is_nothrow_move_assignable_v<T>
+void LockFreeSPMCQueue<T>::CircularArray::store(size_t index, T t) noexcept
 {
-    data_[static_cast<int64_t>(index) & mask_] = std::move(t);
+    data_[static_cast<int64_t>(index) & mask_].store(t, std::memory_order_relaxed);
 }
 
 template<typename T>
-auto LockFreeSPMCQueue<T>::CircularArray::load(size_t index) noexcept -> T
-    requires std::is_nothrow_move_constructible_v<T>
+auto LockFreeSPMCQueue<T>::CircularArray::load(size_t index) const noexcept -> T
 {
-    return data_[static_cast<int64_t>(index) & mask_];
+    return data_[static_cast<int64_t>(index) & mask_].load(std::memory_order_relaxed);
 }
 
 template<typename T>
-auto LockFreeSPMCQueue<T>::CircularArray::resize(int64_t bottom, int64_t top) -> CircularArray*
+auto LockFreeSPMCQueue<T>::CircularArray::resize(int64_t bottom, int64_t top, size_t capacity) const
+  -> CircularArray*
 {
-    auto* ptr = new CircularArray{ static_cast<size_t>(capacity_ * 2u) };
+    assert(bottom <= top || capacity >= static_cast<size_t>(bottom - top));
 
-    for (auto i = top; i != bottom; i++) {
+    auto* ptr = new CircularArray{ capacity };
+
+    for (auto i = top; i < bottom; i++) {
         ptr->store(static_cast<size_t>(i), load(static_cast<size_t>(i)));
     }
 
@@ -110,7 +164,12 @@ LockFreeSPMCQueue<T>::LockFreeSPMCQueue(size_t capacity)
   : top_{ 0 }
   , bottom_{ 0 }
   , buffer_{ new CircularArray{ capacity } }
+  , epoch_{ 0 }
+  , readers_{}
   , garbage_{}
+  , minCapacity_{ capacity }
+  , underuseCount_{ 0 }
+  , maxSize_{ 0 }
 {
     garbage_.reserve(32);
 }
@@ -139,22 +198,33 @@ void LockFreeSPMCQueue<T>::emplaceBottom(Args&&... args)
     auto bottom = bottom_.load(std::memory_order_relaxed);
     auto top = top_.load(std::memory_order_acquire);
 
+    _collectGarbage();
+
     auto* buffer = buffer_.load(std::memory_order_relaxed);
+    auto size = static_cast<size_t>((bottom - top) + 1);
 
-    if (buffer->capacity() < static_cast<size_t>((bottom - top) + 1)) {
-        garbage_.emplace_back(std::exchange(buffer, buffer->resize(bottom, top)));
-        buffer_.store(buffer, std::memory_order_relaxed);
+    if (size > maxSize_.load(std::memory_order_relaxed))
+        maxSize_.store(size, std::memory_order_relaxed);
+
+    if (buffer->capacity() < size) {
+        buffer = buffer->resize(bottom, top, buffer->capacity() * 2);
+        _replaceBuffer(buffer);
     }
 
     buffer->store(static_cast<size_t>(bottom), std::move(item));
 
-    std::atomic_thread_fence(std::memory_order_release);
-
-    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
 }
 
 template<typename T>
 auto LockFreeSPMCQueue<T>::popBottom() -> std::optional<T>
+{
+    return popBottom([](T const&) -> bool { return true; });
+}
+
+template<typename T>
+template<typename Predicate>
+auto LockFreeSPMCQueue<T>::popBottom(Predicate&& accept) -> std::optional<T>
 {
     auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
     auto* buffer = buffer_.load(std::memory_order_relaxed);
@@ -170,16 +240,25 @@ auto LockFreeSPMCQueue<T>::popBottom() -> std::optional<T>
     if (top <= bottom) {
         result = buffer->load(static_cast<size_t>(bottom));
 
+        if (!accept(std::as_const(result.value()))) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
         if (top == bottom) {
             // last item myabe stolen before our write above (stored bottom - 1)
             if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
                 result = std::nullopt;
             }
             bottom_.store(bottom + 1, std::memory_order_relaxed);
+        } else {
+            _shrinkIfUnderused(bottom, top);
         }
     } else {
         bottom_.store(bottom + 1, std::memory_order_relaxed);
         result = std::nullopt;
+
+        _shrinkIfUnderused(bottom + 1, top);
     }
 
     return result;
@@ -187,6 +266,13 @@ auto LockFreeSPMCQueue<T>::popBottom() -> std::optional<T>
 
 template<typename T>
 auto LockFreeSPMCQueue<T>::steal() -> std::optional<T>
+{
+    return steal([](T const&) -> bool { return true; });
+}
+
+template<typename T>
+template<typename Predicate>
+auto LockFreeSPMCQueue<T>::steal(Predicate&& accept) -> std::optional<T>
 {
     auto top = top_.load(std::memory_order_acquire);
 
@@ -197,7 +283,18 @@ auto LockFreeSPMCQueue<T>::steal() -> std::optional<T>
     auto result = std::optional<T>{ std::nullopt };
 
     if (top < bottom) {
-        result = buffer_.load(std::memory_order_consume)->load(static_cast<size_t>(top));
+        // the buffer is not freed until the reader leaves
+        auto& readers = _enterReader();
+        result = buffer_.load(std::memory_order_seq_cst)->load(static_cast<size_t>(top));
+        readers.fetch_sub(1, std::memory_order_release);
+
+        // the item could have been taken and the buffer shrunk before the read, then the slot is not an item,
+        // while the top is the same the read one is a real item and can be shown to the predicate
+        if (top_.load(std::memory_order_seq_cst) != top)
+            return std::nullopt;
+
+        if (!accept(std::as_const(result.value())))
+            return std::nullopt;
 
         if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
             result = std::nullopt;
@@ -209,17 +306,219 @@ auto LockFreeSPMCQueue<T>::steal() -> std::optional<T>
     return result;
 }
 
+template<typename T>
+template<typename Predicate, typename Sink>
+auto LockFreeSPMCQueue<T>::stealBatch(Predicate&& accept, Sink&& sink, size_t maxCount) -> std::optional<T>
+{
+    auto result = steal(accept);
+
+    if (!result)
+        return std::nullopt;
+
+    for (auto i = size_t{ 0 }, count = std::min(size() / 2, maxCount); i < count; i++) {
+        auto item = steal(accept);
+
+        if (!item)
+            break;
+
+        sink(std::move(item.value()));
+    }
+
+    return result;
+}
+
+template<typename T>
+auto LockFreeSPMCQueue<T>::_enterReader() -> std::atomic<int64_t>&
+{
+    // a reader late for the epoch it has read makes the owner wait one more epoch, it is still safe:
+    // the counter it got into is the one the owner checks before the next advance
+    auto& readers = readers_[epoch_.load(std::memory_order_seq_cst) & 1];
+    readers.fetch_add(1, std::memory_order_seq_cst);
+
+    return readers;
+}
+
+template<typename T>
+void LockFreeSPMCQueue<T>::_replaceBuffer(CircularArray* buffer)
+{
+    auto* retired = buffer_.exchange(buffer, std::memory_order_seq_cst);
+
+    garbage_.push_back(
+      retired_buffer_t{ std::unique_ptr<CircularArray>{ retired }, epoch_.load(std::memory_order_relaxed) });
+}
+
+template<typename T>
+void LockFreeSPMCQueue<T>::_collectGarbage()
+{
+    if (garbage_.empty())
+        return;
+
+    auto epoch = epoch_.load(std::memory_order_relaxed);
+
+    // the next epoch reuses the counter of the previous one
+    if (readers_[(epoch + 1) & 1].load(std::memory_order_seq_cst) == 0)
+        epoch_.store(++epoch, std::memory_order_seq_cst);
+
+    // readers of the retiring epoch and the one before it are over after two advances
+    std::erase_if(garbage_, [epoch](retired_buffer_t const& retired) -> bool { return retired.epoch + 2 <= epoch; });
+}
+
+template<typename T>
+void LockFreeSPMCQueue<T>::_shrinkIfUnderused(int64_t bottom, int64_t top)
+{
+    _collectGarbage();
+
+    auto* buffer = buffer_.load(std::memory_order_relaxed);
+    auto size = static_cast<size_t>(bottom > top ? bottom - top : 0);
+
+    if (buffer->capacity() <= minCapacity_ || size * 4 >= buffer->capacity()) {
+        underuseCount_ = 0;
+        return;
+    }
+
+    if (++underuseCount_ < shrink_delay_v)
+        return;
+
+    underuseCount_ = 0;
+
+    // the item at bottom is already taken by the owner, thieves could take some from top meanwhile,
+    // but the copied slots still hold the same items
+    // at most a half filled after that, one copy instead of halving step by step
+    _replaceBuffer(buffer->resize(bottom, top, std::max(minCapacity_, std::bit_ceil(size * 2))));
+}
+
 template<typename T>
 LockFreeSPMCQueue<T>::~LockFreeSPMCQueue() noexcept
 {
     delete buffer_.load(std::memory_order_relaxed);
 }
 
+// bounded ring for any number of producers and consumers, every cell has a sequence number
+// which tells whether the cell is ready for the push or the pop at the position
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+template<typename T>
+class LockFreeMPMCQueue
+{
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>);
+
+    struct cell_t
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+public:
+    explicit LockFreeMPMCQueue(size_t capacity);
+
+    LockFreeMPMCQueue(LockFreeMPMCQueue const&) = delete;
+
+    LockFreeMPMCQueue(LockFreeMPMCQueue&&) = delete;
+
+    ~LockFreeMPMCQueue() = default;
+
+    auto operator=(LockFreeMPMCQueue const&) -> LockFreeMPMCQueue& = delete;
+
+    auto operator=(LockFreeMPMCQueue&&) -> LockFreeMPMCQueue& = delete;
+
+    [[nodiscard]] auto capacity() const -> size_t { return mask_ + 1; }
+
+    // approximate while somebody pushes or pops
+    [[nodiscard]] auto size() const -> size_t;
+
+    [[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+    // false if the queue is full
+    auto tryPush(T item) -> bool;
+
+    auto tryPop() -> std::optional<T>;
+
+private:
+    std::unique_ptr<cell_t[]> cells_;
+    size_t mask_;
+
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> pushPosition_;
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> popPosition_;
+};
+
+template<typename T>
+LockFreeMPMCQueue<T>::LockFreeMPMCQueue(size_t capacity)
+  : cells_{ std::make_unique<cell_t[]>(capacity) }
+  , mask_{ capacity - 1 }
+  , pushPosition_{ 0 }
+  , popPosition_{ 0 }
+{
+    assert(capacity > 1);
+    assert(std::has_single_bit(capacity));
+
+    for (auto i = size_t{ 0 }; i < capacity; i++)
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template<typename T>
+auto LockFreeMPMCQueue<T>::size() const -> size_t
+{
+    auto pushPosition = pushPosition_.load(std::memory_order_relaxed);
+    auto popPosition = popPosition_.load(std::memory_order_relaxed);
+
+    return pushPosition > popPosition ? pushPosition - popPosition : 0;
+}
+
+template<typename T>
+auto LockFreeMPMCQueue<T>::tryPush(T item) -> bool
+{
+    auto position = pushPosition_.load(std::memory_order_relaxed);
+
+    while (true) {
+        auto& cell = cells_[position & mask_];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+        if (difference == 0) {
+            if (pushPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.data = std::move(item);
+                cell.sequence.store(position + 1, std::memory_order_release);
+
+                return true;
+            }
+        } else if (difference < 0) {
+            // the cell still keeps the item pushed a lap ago
+            return false;
+        } else {
+            position = pushPosition_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+auto LockFreeMPMCQueue<T>::tryPop() -> std::optional<T>
+{
+    auto position = popPosition_.load(std::memory_order_relaxed);
+
+    while (true) {
+        auto& cell = cells_[position & mask_];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+        if (difference == 0) {
+            if (popPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                auto item = std::optional<T>{ std::move(cell.data) };
+                cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+
+                return item;
+            }
+        } else if (difference < 0) {
+            return std::nullopt;
+        } else {
+            position = popPosition_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
 template<typename T>
 using lock_free_spmc_queue_t = LockFreeSPMCQueue<T>;
 
 template<typename T>
-using lock_free_mpmc_queue_t = boost::lockfree::queue<T>;
+using lock_free_mpmc_queue_t = LockFreeMPMCQueue<T>;
 }
 
 #endif // CYCLONITE_LOCKFREEQUEUE_H
@@ -0,0 +1,53 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "parkingLot.h"
+
+namespace cyclonite::multithreading {
+ParkingLot::ParkingLot() noexcept
+  : epoch_{ 0 }
+  , sleepers_{ 0 }
+{
+}
+
+auto ParkingLot::_prepare() -> uint32_t
+{
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+
+    // pairs with the fence in notify, either the sleeper sees new work or the notifier sees the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    return epoch_.load(std::memory_order_acquire);
+}
+
+void ParkingLot::_cancel()
+{
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ParkingLot::_wait(uint32_t ticket)
+{
+    epoch_.wait(ticket, std::memory_order_acquire);
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ParkingLot::notifyOne()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (sleepers_.load(std::memory_order_relaxed) == 0)
+        return;
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_one();
+}
+
+void ParkingLot::notifyAll()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_all();
+}
+}
@@ -0,0 +1,66 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_PARKINGLOT_H
+#define CYCLONITE_PARKINGLOT_H
+
+#include "typedefs.h"
+#include <atomic>
+#include <cstdint>
+
+namespace cyclonite::multithreading {
+// place where idle threads sleep until somebody submits new work
+// the sleeper announces itself first and re-checks for work after that,
+// so a notification can not be lost in between
+class ParkingLot
+{
+public:
+    ParkingLot() noexcept;
+
+    ParkingLot(ParkingLot const&) = delete;
+
+    ParkingLot(ParkingLot&&) = delete;
+
+    ~ParkingLot() = default;
+
+    auto operator=(ParkingLot const&) -> ParkingLot& = delete;
+
+    auto operator=(ParkingLot&&) -> ParkingLot& = delete;
+
+    template<typename Predicate>
+    void park(Predicate&& hasWork);
+
+    void notifyOne();
+
+    void notifyAll();
+
+    [[nodiscard]] auto sleeperCount() const -> uint32_t { return sleepers_.load(std::memory_order_relaxed); }
+
+private:
+    auto _prepare() -> uint32_t;
+
+    void _cancel();
+
+    void _wait(uint32_t ticket);
+
+private:
+    alignas(hardware_destructive_interference_size) std::atomic<uint32_t> epoch_;
+    alignas(hardware_destructive_interference_size) std::atomic<uint32_t> sleepers_;
+};
+
+template<typename Predicate>
+void ParkingLot::park(Predicate&& hasWork)
+{
+    auto ticket = _prepare();
+
+    if (hasWork()) {
+        _cancel();
+        return;
+    }
+
+    _wait(ticket);
+}
+}
+
+#endif // CYCLONITE_PARKINGLOT_H
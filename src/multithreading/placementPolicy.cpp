@@ -0,0 +1,109 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "placementPolicy.h"
+#include <algorithm>
+#include <tuple>
+
+namespace cyclonite::multithreading {
+PlacementPolicy::PlacementPolicy() noexcept
+  : pinRenderThread_{ false }
+  , pinWorkers_{ false }
+  , skipSmtSiblings_{ false }
+  , cpuSet_{}
+{
+}
+
+auto PlacementPolicy::withPinnedRenderThread() const -> PlacementPolicy
+{
+    auto policy = *this;
+    policy.pinRenderThread_ = true;
+    return policy;
+}
+
+auto PlacementPolicy::withPinnedWorkers() const -> PlacementPolicy
+{
+    auto policy = *this;
+    policy.pinWorkers_ = true;
+    return policy;
+}
+
+auto PlacementPolicy::withoutSmtSiblings() const -> PlacementPolicy
+{
+    auto policy = *this;
+    policy.skipSmtSiblings_ = true;
+    return policy;
+}
+
+auto PlacementPolicy::withCpuSet(std::vector<uint32_t> cpus) const -> PlacementPolicy
+{
+    auto policy = *this;
+    policy.cpuSet_ = std::move(cpus);
+
+    std::sort(policy.cpuSet_.begin(), policy.cpuSet_.end());
+
+    return policy;
+}
+
+auto PlacementPolicy::place(CpuTopology const& topology, size_t workerCount) const -> ThreadPlacement
+{
+    auto placement = ThreadPlacement{ {}, std::vector<std::vector<uint32_t>>(workerCount) };
+
+    // nothing to restrict
+    if (!pinRenderThread_ && !pinWorkers_ && !skipSmtSiblings_ && cpuSet_.empty())
+        return placement;
+
+    auto candidates = _candidates(topology);
+
+    if (candidates.empty())
+        return placement;
+
+    auto all = std::vector<uint32_t>{};
+    all.reserve(candidates.size());
+
+    for (auto&& cpu : candidates)
+        all.push_back(cpu.id);
+
+    // threads which are not pinned are restricted only by the cpu set and the smt filter
+    auto floating = skipSmtSiblings_ || !cpuSet_.empty() ? all : std::vector<uint32_t>{};
+
+    placement.renderThreadCpus = pinRenderThread_ ? std::vector<uint32_t>{ all.front() } : floating;
+
+    if (!pinWorkers_) {
+        std::fill(placement.workerCpus.begin(), placement.workerCpus.end(), floating);
+        return placement;
+    }
+
+    // the render thread keeps its core to itself while there are enough cores for everybody
+    auto first = pinRenderThread_ && all.size() > workerCount ? size_t{ 1 } : size_t{ 0 };
+
+    for (auto i = size_t{ 0 }; i < workerCount; i++)
+        placement.workerCpus[i] = { all[first + i % (all.size() - first)] };
+
+    return placement;
+}
+
+auto PlacementPolicy::_candidates(CpuTopology const& topology) const -> std::vector<LogicalCpu>
+{
+    auto candidates = std::vector<LogicalCpu>{};
+
+    for (auto&& cpu : topology.cpus()) {
+        if (!cpu.allowed || (skipSmtSiblings_ && !cpu.primary))
+            continue;
+
+        if (!cpuSet_.empty() && !std::binary_search(cpuSet_.begin(), cpuSet_.end(), cpu.id))
+            continue;
+
+        candidates.push_back(cpu);
+    }
+
+    // a core of its own first, then the fastest ones, the first package is filled before the next one
+    std::sort(candidates.begin(), candidates.end(), [](LogicalCpu const& lhs, LogicalCpu const& rhs) -> bool {
+        return std::make_tuple(!lhs.primary, -static_cast<int64_t>(lhs.capacity), lhs.package, lhs.core, lhs.id) <
+               std::make_tuple(!rhs.primary, -static_cast<int64_t>(rhs.capacity), rhs.package, rhs.core, rhs.id);
+    });
+
+    return candidates;
+}
+}
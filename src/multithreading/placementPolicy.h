@@ -0,0 +1,61 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_PLACEMENTPOLICY_H
+#define CYCLONITE_PLACEMENTPOLICY_H
+
+#include "cpuTopology.h"
+#include <vector>
+
+namespace cyclonite::multithreading {
+// cpus of every thread of the task manager, the os schedules a thread with no cpus freely
+struct ThreadPlacement
+{
+    std::vector<uint32_t> renderThreadCpus;
+    std::vector<std::vector<uint32_t>> workerCpus; // the first one is the main thread
+};
+
+// places the threads of the task manager on cpus, nothing is restricted by default,
+// e.g. PlacementPolicy{}.withPinnedRenderThread().withPinnedWorkers().withoutSmtSiblings()
+// threads which are not pinned float over all of the cpus left by the cpu set and the smt filter
+class PlacementPolicy
+{
+public:
+    PlacementPolicy() noexcept;
+
+    // the render thread gets the fastest core of the first package
+    [[nodiscard]] auto withPinnedRenderThread() const -> PlacementPolicy;
+
+    // one worker per physical core as long as there are enough of them, smt siblings go after all cores
+    [[nodiscard]] auto withPinnedWorkers() const -> PlacementPolicy;
+
+    // the second hardware threads of cores are not used at all
+    [[nodiscard]] auto withoutSmtSiblings() const -> PlacementPolicy;
+
+    // only these cpus are used (the ones out of the process affinity mask are ignored anyway)
+    [[nodiscard]] auto withCpuSet(std::vector<uint32_t> cpus) const -> PlacementPolicy;
+
+    [[nodiscard]] auto pinsRenderThread() const -> bool { return pinRenderThread_; }
+
+    [[nodiscard]] auto pinsWorkers() const -> bool { return pinWorkers_; }
+
+    [[nodiscard]] auto skipsSmtSiblings() const -> bool { return skipSmtSiblings_; }
+
+    [[nodiscard]] auto cpuSet() const -> std::vector<uint32_t> const& { return cpuSet_; }
+
+    [[nodiscard]] auto place(CpuTopology const& topology, size_t workerCount) const -> ThreadPlacement;
+
+private:
+    // usable cpus, faster and less loaded cores go first
+    [[nodiscard]] auto _candidates(CpuTopology const& topology) const -> std::vector<LogicalCpu>;
+
+private:
+    bool pinRenderThread_;
+    bool pinWorkers_;
+    bool skipSmtSiblings_;
+    std::vector<uint32_t> cpuSet_;
+};
+}
+
+#endif // CYCLONITE_PLACEMENTPOLICY_H
@@ -19,8 +19,14 @@ auto Render::isInRenderThread() -> bool
     return _renderThread;
 }
 
-Render::Render(cyclonite::multithreading::TaskManager& taskManager) noexcept
+Render::Render(cyclonite::multithreading::TaskManager& taskManager, size_t size)
   : taskManager_{ &taskManager }
+  , taskPool_{ size }
+  , workerQueue_{ std::make_unique<lock_free_spmc_queue_t<Task*>>(size) }
+  , executedTasks_{}
+  , stealAttempts_{}
+  , steals_{}
+  , idleNanoseconds_{}
 {
 }
 
@@ -29,12 +35,19 @@ void Render::operator()()
     assert(_renderThread == nullptr);
     _renderThread = this;
 
+    CYCLONITE_TRACE_THREAD_NAME("render");
+
     try {
+        auto idler = Idler{ taskManager().idlePolicy(), taskManager().renderParkingLot(), &idleNanoseconds_ };
+
         while (taskManager().keepAlive()) {
-            if (auto task = pendingTask()) {
-                task.value()();
+            if (auto* task = pendingTask()) {
+                taskManager().execute(*task);
+                executedTasks_.add(1);
+                idler.reset();
             } else {
-                std::this_thread::yield();
+                idler.idle(
+                  [this]() -> bool { return taskManager().hasPendingRenderTasks() || !taskManager().keepAlive(); });
             }
         }
     } catch (...) {
@@ -42,17 +55,52 @@ void Render::operator()()
     }
 }
 
-auto Render::pendingTask() -> std::optional<Task>
+auto Render::pendingTask() -> Task*
 {
-    auto task = std::optional<Task>{ std::nullopt };
-
     auto workerCount = taskManager().workerCount();
-    auto workerIndex = internal::randomWorkerIndex(workerCount);
+    auto firstWorkerIndex = internal::randomWorkerIndex(workerCount);
+
+    for (auto i = size_t{ 0 }; i < workerCount; i++) {
+        auto& queue = taskManager().renderQueue((firstWorkerIndex + i) % workerCount);
+
+        if (queue.empty())
+            continue;
 
-    if (auto stolenTaskPtr = taskManager().renderQueue(workerIndex).steal()) {
-        task = std::move(*stolenTaskPtr.value());
+        stealAttempts_.add(1);
+
+        if (auto stolenTaskPtr = queue.steal()) {
+            steals_.add(1);
+            return stolenTaskPtr.value();
+        }
     }
 
-    return task;
+    return nullptr;
+}
+
+auto Render::metrics() const -> ThreadMetrics
+{
+    // render tasks are stolen one by one from the workers, there is no own queue to pop
+    return ThreadMetrics{ executedTasks_.load(),
+                          0,
+                          0,
+                          stealAttempts_.load(),
+                          steals_.load(),
+                          steals_.load(),
+                          idleNanoseconds_.load(),
+                          0,
+                          workerQueue_->maxSize(),
+                          taskPool_.size(),
+                          taskPool_.capacity(),
+                          taskPool_.highWaterMark() };
+}
+
+auto Render::_nextSequence() -> uint64_t
+{
+    return taskManager().nextSequence();
+}
+
+void Render::_notifyWorkers()
+{
+    taskManager().workerParkingLot().notifyOne();
+}
 }
-}
\ No newline at end of file
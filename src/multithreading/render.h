@@ -6,8 +6,10 @@
 #define CYCLONITE_RENDER_H
 
 #include "lockFreeQueue.h"
+#include "schedulerMetrics.h"
 #include "taskPool.h"
 #include <future>
+#include <memory>
 
 namespace cyclonite::multithreading {
 class TaskManager;
@@ -15,9 +17,10 @@ class TaskManager;
 class Render
 {
     friend class TaskManager;
+    friend class Worker;
 
 public:
-    explicit Render(TaskManager& taskManager) noexcept;
+    Render(TaskManager& taskManager, size_t size);
 
     Render(Render const&) = delete;
 
@@ -31,20 +34,58 @@ public:
 
     void operator()();
 
+    // the task goes to the own queue of the render thread, it is executed by the workers who steal it,
+    // workers take it along with their frame-critical lane
+    template<TaskFunctor F>
+    void submitDetachedTask(F&& f);
+
+    // a snapshot of the counters, it could be taken from any thread
+    [[nodiscard]] auto metrics() const -> ThreadMetrics;
+
     [[nodiscard]] auto taskManager() const -> TaskManager const& { return *taskManager_; }
     auto taskManager() -> TaskManager& { return *taskManager_; }
 
 private:
-    auto pendingTask() -> std::optional<Task>;
+    auto pendingTask() -> Task*;
 
-    static auto renderThread() -> Render&;
+    [[nodiscard]] auto pool() const -> TaskPool const& { return taskPool_; }
+    auto pool() -> TaskPool& { return taskPool_; }
+
+    [[nodiscard]] auto queue() const -> lock_free_spmc_queue_t<Task*> const& { return *workerQueue_; }
+    auto queue() -> lock_free_spmc_queue_t<Task*>& { return *workerQueue_; }
+
+    auto _nextSequence() -> uint64_t;
+
+    void _notifyWorkers();
 
 public:
     static auto isInRenderThread() -> bool;
 
+    static auto renderThread() -> Render&;
+
 private:
     TaskManager* taskManager_;
+    TaskPool taskPool_;
+    std::unique_ptr<lock_free_spmc_queue_t<Task*>> workerQueue_;
+
+    internal::MetricCounter executedTasks_;
+    internal::MetricCounter stealAttempts_;
+    internal::MetricCounter steals_;
+    internal::MetricCounter idleNanoseconds_;
 };
+
+template<TaskFunctor F>
+void Render::submitDetachedTask(F&& f)
+{
+    assert(isInRenderThread() && &renderThread() == this);
+
+    auto* task = pool().writeableTask();
+    task->emplace(std::forward<F>(f), _nextSequence(), TaskPriority::FRAME_CRITICAL);
+
+    queue().emplaceBottom(task);
+
+    _notifyWorkers();
+}
 }
 
 #endif // CYCLONITE_RENDER_H
@@ -0,0 +1,90 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_SCHEDULERMETRICS_H
+#define CYCLONITE_SCHEDULERMETRICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cyclonite::multithreading {
+// counters of a thread of the task manager since the start
+struct ThreadMetrics
+{
+    uint64_t executedTasks;
+    uint64_t localPops;          // tasks taken from the own queues
+    uint64_t injectedPops;       // tasks taken from the injection queues
+    uint64_t stealAttempts;      // steals from non-empty victims
+    uint64_t steals;             // attempts which got a task
+    uint64_t stolenTasks;        // including the ones moved by batches
+    uint64_t idleNanoseconds;    // spinning or parked with nothing to do
+    uint64_t waitingNanoseconds; // yielding in waitFor with nothing to help with
+    size_t maxQueueDepth;        // the deepest of the own queues
+    size_t taskPoolSize;         // task slots in use right now
+    size_t taskPoolCapacity;
+    size_t taskPoolHighWaterMark;
+};
+
+struct SchedulerMetrics
+{
+    std::vector<ThreadMetrics> workers;
+    ThreadMetrics render;
+
+    // sums over all of the threads, the max of queue depths
+    [[nodiscard]] auto total() const -> ThreadMetrics;
+};
+
+namespace internal {
+// written by the owner thread only, so an update is a relaxed load and store instead of an atomic add,
+// anybody can read it
+class MetricCounter
+{
+public:
+    MetricCounter() noexcept
+      : value_{ 0 }
+    {
+    }
+
+    void add(uint64_t n) { value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+
+    void max(uint64_t n)
+    {
+        if (n > value_.load(std::memory_order_relaxed))
+            value_.store(n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto load() const -> uint64_t { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_;
+};
+}
+
+inline auto SchedulerMetrics::total() const -> ThreadMetrics
+{
+    auto total = render;
+
+    for (auto&& worker : workers) {
+        total.executedTasks += worker.executedTasks;
+        total.localPops += worker.localPops;
+        total.injectedPops += worker.injectedPops;
+        total.stealAttempts += worker.stealAttempts;
+        total.steals += worker.steals;
+        total.stolenTasks += worker.stolenTasks;
+        total.idleNanoseconds += worker.idleNanoseconds;
+        total.waitingNanoseconds += worker.waitingNanoseconds;
+        total.maxQueueDepth = std::max(total.maxQueueDepth, worker.maxQueueDepth);
+        total.taskPoolSize += worker.taskPoolSize;
+        total.taskPoolCapacity += worker.taskPoolCapacity;
+        total.taskPoolHighWaterMark += worker.taskPoolHighWaterMark;
+    }
+
+    return total;
+}
+}
+
+#endif // CYCLONITE_SCHEDULERMETRICS_H
@@ -9,51 +9,60 @@ namespace cyclonite::multithreading {
 Task::Task()
   : storage_{}
   , functor_{ nullptr }
+  , functorArena_{ nullptr }
+  , resultDeleter_{ nullptr }
+  , exception_{}
   , pending_{ false }
+  , ready_{ false }
+  , hasFuture_{ false }
+  , priority_{ TaskPriority::NORMAL }
+  , sequence_{ 0 }
+  , pool_{ nullptr }
+  , slot_{ std::numeric_limits<uint32_t>::max() }
+  , refCount_{ 0 }
+  , next_{ std::numeric_limits<uint32_t>::max() }
+  , generation_{ 0 }
 {
 }
 
-Task::Task(Task&& task) noexcept
-  : storage_{}
-  , functor_{ nullptr }
-  , pending_{ false }
+void Task::operator()()
 {
-    assert(task.functor_);
+    assert(functor_);
 
-    if (task.functor_ == task.storage()) {
-        functor_ = task.functor_->move_to(storage_);
-        std::exchange(task.functor_, nullptr)->~functor_base_t();
-    } else {
-        functor_ = std::exchange(task.functor_, nullptr);
+    try {
+        functor_->invoke(*this);
+    } catch (...) {
+        _fail(std::current_exception());
     }
-
-    pending_.store(functor_ != nullptr, std::memory_order_release);
-    task.pending_.store(false, std::memory_order_release);
 }
 
-auto Task::operator=(Task&& rhs) noexcept -> Task&
+void Task::_attachFuture()
 {
-    assert(rhs.functor_);
+    // happens before the task gets into a queue
+    assert(pending());
 
-    _reset();
-
-    if (rhs.functor_ == rhs.storage()) {
-        functor_ = rhs.functor_->move_to(storage_);
-        rhs.functor_ = nullptr;
-    } else {
-        functor_ = std::exchange(rhs.functor_, nullptr);
-    }
+    hasFuture_ = true;
+    _retain();
+}
 
-    pending_.store(functor_ != nullptr, std::memory_order_release);
-    rhs.pending_.store(false, std::memory_order_release);
+void Task::_retain()
+{
+    refCount_.fetch_add(1, std::memory_order_relaxed);
+}
 
-    return *this;
+void Task::_wait() const
+{
+    while (!ready())
+        ready_.wait(false, std::memory_order_acquire);
 }
 
-void Task::_reset()
+void Task::_destroyFunctor()
 {
     if (functor_ == storage()) {
         functor_->~functor_base_t();
+    } else if (functorArena_ != nullptr) {
+        functor_->~functor_base_t();
+        std::exchange(functorArena_, nullptr)->release();
     } else {
         delete functor_;
     }
@@ -61,14 +70,49 @@ void Task::_reset()
     functor_ = nullptr;
 }
 
-void Task::operator()()
+void Task::_complete()
 {
-    assert(functor_);
-    functor_->invoke();
+    _destroyFunctor();
+
+    pending_.store(false, std::memory_order_relaxed);
+    ready_.store(true, std::memory_order_release);
+    ready_.notify_all();
+}
+
+void Task::_fail(std::exception_ptr exception)
+{
+    exception_ = std::move(exception);
+
+    _complete();
+}
+
+void Task::_rethrow() const
+{
+    assert(ready());
+
+    if (exception_)
+        std::rethrow_exception(exception_);
+}
+
+void Task::_reset()
+{
+    assert(!pending());
+
+    _destroyFunctor();
+
+    if (resultDeleter_ != nullptr) {
+        resultDeleter_(storage());
+        resultDeleter_ = nullptr;
+    }
+
+    exception_ = nullptr;
+    ready_.store(false, std::memory_order_relaxed);
 }
 
 Task::~Task()
 {
+    // the task could be never executed if the manager is stopped
+    pending_.store(false, std::memory_order_relaxed);
     _reset();
 }
-}
\ No newline at end of file
+}
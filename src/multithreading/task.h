@@ -5,13 +5,42 @@
 #ifndef CYCLONITE_TASK_H
 #define CYCLONITE_TASK_H
 
+#include "../profiling/tracer.h"
+#include "frameArena.h"
 #include "typedefs.h"
+#include <array>
 #include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <exception>
 #include <functional>
-#include <array>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
 
 namespace cyclonite::multithreading {
 class Task;
+class TaskPool;
+
+template<typename T>
+class Future;
+
+template<typename T>
+class SharedFuture;
+
+// scheduler lanes, workers drain them in this order
+enum class TaskPriority : uint8_t
+{
+    FRAME_CRITICAL = 0, // work of the current frame
+    NORMAL = 1,
+    BACKGROUND = 2, // streaming, resource loading, etc., it must not delay a frame
+    MIN_VALUE = FRAME_CRITICAL,
+    MAX_VALUE = BACKGROUND,
+    COUNT = MAX_VALUE + 1
+};
+
+static constexpr size_t task_priority_count_v = static_cast<size_t>(TaskPriority::COUNT);
 
 template<typename F>
 concept TaskFunctor = requires(F&& f) {
@@ -19,11 +48,22 @@ concept TaskFunctor = requires(F&& f) {
                           std::invoke(std::forward<F>(f));
                       };
 
+// pooled task slot, it is executed in place and keeps the result until the last future is gone,
+// so neither the functor nor the result needs a heap allocation while they fit the storage,
+// the ones which don't fit go to the heap, a reference result is kept as a pointer
 class alignas(hardware_constructive_interference_size) Task
 {
+    friend class TaskPool;
+
+    template<typename T>
+    friend class Future;
+
+    template<typename T>
+    friend class SharedFuture;
+
     static constexpr size_t storage_size_v = 64;
 
-    using storage_t = std::array<std::byte, 64>;
+    using storage_t = std::array<std::byte, storage_size_v>;
 
     struct functor_base_t
     {
@@ -31,8 +71,8 @@ class alignas(hardware_constructive_interference_size) Task
 
         virtual ~functor_base_t() = default;
 
-        virtual void invoke() = 0;
-        virtual auto move_to(storage_t& storage) -> functor_base_t* = 0;
+        // executes the functor and stores the result into the task, destroys the functor
+        virtual void invoke(Task& task) = 0;
     };
 
     template<typename F>
@@ -48,71 +88,194 @@ class alignas(hardware_constructive_interference_size) Task
         {
         }
 
-        void invoke() override { f_(); };
-
-        auto move_to(storage_t& storage) -> functor_base_t* override;
+        void invoke(Task& task) override;
 
     private:
         F f_;
     };
 
+    template<typename F>
+    static constexpr bool is_inplace_v =
+      sizeof(functor_t<F>) <= storage_size_v && alignof(functor_t<F>) <= alignof(std::max_align_t);
+
+    template<typename R>
+    using stored_result_t = std::conditional_t<std::is_reference_v<R>, std::remove_reference_t<R>*, R>;
+
+    template<typename R>
+    static constexpr bool is_inplace_result_v = sizeof(R) <= storage_size_v && alignof(R) <= alignof(std::max_align_t);
+
 public:
     Task();
 
-    template<TaskFunctor F>
-    explicit Task(F&& f);
-
     Task(Task const&) = delete;
 
-    Task(Task&& task) noexcept;
+    Task(Task&&) = delete;
 
     auto operator=(Task const&) -> Task& = delete;
 
-    auto operator=(Task&& rhs) noexcept -> Task&;
+    auto operator=(Task&&) -> Task& = delete;
+
+    ~Task();
+
+    // places the functor into the slot, the executing thread owns the first reference,
+    // a functor which does not fit the slot goes to the arena if there is one, to the heap otherwise
+    template<TaskFunctor F>
+    void emplace(F&& f, uint64_t sequence, TaskPriority priority, FrameArena* arena = nullptr);
 
     void operator()();
 
     [[nodiscard]] auto pending() const -> bool { return pending_.load(std::memory_order_acquire); }
 
-    ~Task();
+    [[nodiscard]] auto ready() const -> bool { return ready_.load(std::memory_order_acquire); }
 
-private:
-    void _reset();
+    // true if nobody is going to get the result, so the failure must be reported by the executor
+    [[nodiscard]] auto detached() const -> bool { return !hasFuture_; }
 
+    [[nodiscard]] auto exception() const -> std::exception_ptr const& { return exception_; }
+
+    // submission order, the waiting thread uses it to pick tasks which can not depend on the waiting one
+    [[nodiscard]] auto sequence() const -> uint64_t { return sequence_.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] auto priority() const -> TaskPriority { return priority_; }
+
+    // every time the pool slot gets reused, the generation increases
+    [[nodiscard]] auto generation() const -> uint32_t { return generation_.load(std::memory_order_acquire); }
+
+private:
     auto storage() -> void* { return storage_.data(); }
 
+    void _attachFuture();
+
+    void _retain();
+
+    void _wait() const;
+
+    void _destroyFunctor();
+
+    void _complete();
+
+    template<typename R>
+    void _complete(R&& result);
+
+    void _fail(std::exception_ptr exception);
+
+    void _rethrow() const;
+
+    template<typename R>
+    auto _result() -> R&;
+
+    // destroys the result, the slot is free after that
+    void _reset();
+
 private:
-    storage_t storage_;
+    alignas(std::max_align_t) storage_t storage_;
     functor_base_t* functor_;
+    FrameArena* functorArena_;
+    void (*resultDeleter_)(void*);
+    std::exception_ptr exception_;
     std::atomic<bool> pending_;
+    std::atomic<bool> ready_;
+    bool hasFuture_;
+    TaskPriority priority_;
+    std::atomic<uint64_t> sequence_;
+
+    // pool slot
+    TaskPool* pool_;
+    uint32_t slot_;
+    std::atomic<uint32_t> refCount_;
+    std::atomic<uint32_t> next_;
+    std::atomic<uint32_t> generation_;
 };
 
 template<TaskFunctor F>
-Task::Task(F&& f)
-  : storage_{}
-  , functor_{ nullptr }
-  , pending_{ false }
+void Task::emplace(F&& f, uint64_t sequence, TaskPriority priority, FrameArena* arena)
 {
-    if constexpr (sizeof(functor_t<F>) <= sizeof(storage_t)) {
-        functor_ = new (storage()) functor_t<F>{ std::forward<F>(f) };
+    using functor_type_t = functor_t<std::decay_t<F>>;
+
+    assert(functor_ == nullptr);
+    assert(!pending());
+
+    if constexpr (is_inplace_v<std::decay_t<F>>) {
+        functor_ = new (storage()) functor_type_t{ std::forward<F>(f) };
+    } else if (arena != nullptr) {
+        functor_ = new (arena->acquire(sizeof(functor_type_t), alignof(functor_type_t)))
+          functor_type_t{ std::forward<F>(f) };
+        functorArena_ = arena;
     } else {
-        functor_ = new functor_t<F>{ std::forward<F>(f) };
+        functor_ = new functor_type_t{ std::forward<F>(f) };
     }
 
-    pending_.store(functor_ != nullptr, std::memory_order_relaxed);
+    hasFuture_ = false;
+    priority_ = priority;
+    sequence_.store(sequence, std::memory_order_relaxed);
+    refCount_.store(1, std::memory_order_relaxed);
+    ready_.store(false, std::memory_order_relaxed);
+    pending_.store(true, std::memory_order_release);
+
+    CYCLONITE_TRACE_FLOW_BEGIN(sequence);
 }
 
 template<typename F>
-auto Task::functor_t<F>::move_to(storage_t& storage) -> functor_base_t*
+void Task::functor_t<F>::invoke(Task& task)
 {
-    functor_base_t* r = nullptr;
+    using result_type_t = std::invoke_result_t<F&>;
 
-    if constexpr (sizeof(f_) <= sizeof(storage_t)) {
-        r = new (storage.data()) functor_t<std::decay_t<decltype(f_)>>{ std::move(f_) };
+    if constexpr (std::is_void_v<result_type_t>) {
+        std::invoke(f_);
+        task._complete();
+    } else if constexpr (std::is_reference_v<result_type_t>) {
+        task._complete(std::addressof(std::invoke(f_)));
+    } else {
+        task._complete(std::invoke(f_));
     }
+}
+
+template<typename R>
+void Task::_complete(R&& result)
+{
+    using result_type_t = std::decay_t<R>;
+
+    // the result could be a part of the functor, so it is taken before the functor is gone
+    if constexpr (is_inplace_result_v<result_type_t>) {
+        auto value = result_type_t(std::forward<R>(result));
+
+        _destroyFunctor();
 
-    assert(r != nullptr);
-    return r;
+        new (storage()) result_type_t(std::move(value));
+        resultDeleter_ = [](void* ptr) -> void { static_cast<result_type_t*>(ptr)->~result_type_t(); };
+    } else {
+        auto* value = new result_type_t(std::forward<R>(result));
+
+        _destroyFunctor();
+
+        new (storage()) result_type_t*(value);
+        resultDeleter_ = [](void* ptr) -> void { delete *static_cast<result_type_t**>(ptr); };
+    }
+
+    _complete();
+}
+
+template<typename R>
+auto Task::_result() -> R&
+{
+    using stored_t = stored_result_t<R>;
+
+    assert(ready());
+    assert(resultDeleter_ != nullptr);
+
+    auto* value = static_cast<stored_t*>(nullptr);
+
+    if constexpr (is_inplace_result_v<stored_t>) {
+        value = std::launder(reinterpret_cast<stored_t*>(storage()));
+    } else {
+        value = *std::launder(reinterpret_cast<stored_t**>(storage()));
+    }
+
+    if constexpr (std::is_reference_v<R>) {
+        return **value;
+    } else {
+        return *value;
+    }
 }
 }
 
@@ -0,0 +1,174 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "taskGraph.h"
+#include <algorithm>
+
+namespace cyclonite::multithreading {
+TaskGraph::TaskGraph(TaskPriority priority) noexcept
+  : nodes_{}
+  , priority_{ priority }
+  , pendingPredecessors_{}
+  , counterCount_{ 0 }
+  , exception_{}
+  , failed_{ false }
+  , remaining_{ 0 }
+{
+}
+
+TaskGraph::~TaskGraph()
+{
+    // nodes refer to the graph
+    assert(done());
+}
+
+void TaskGraph::addEdge(node_id_t predecessor, node_id_t successor)
+{
+    assert(done());
+    assert(predecessor < nodes_.size() && successor < nodes_.size());
+    assert(predecessor != successor);
+
+    auto& successors = nodes_[predecessor].successors;
+
+    if (std::find(successors.begin(), successors.end(), successor) != successors.end())
+        return;
+
+    successors.push_back(successor);
+    nodes_[successor].predecessorCount++;
+}
+
+void TaskGraph::launch()
+{
+    assert(done());
+    assert(Worker::isInWorkerThread());
+
+    if (nodes_.empty())
+        return;
+
+    _prepare();
+
+    auto& worker = Worker::threadWorker();
+
+    for (auto i = size_t{ 0 }, count = nodes_.size(); i < count; i++) {
+        pendingPredecessors_[i].store(nodes_[i].predecessorCount, std::memory_order_relaxed);
+    }
+
+    exception_ = nullptr;
+    failed_.store(false, std::memory_order_relaxed);
+    remaining_.store(static_cast<uint32_t>(nodes_.size()), std::memory_order_relaxed);
+
+    // submission publishes everything above to the executing threads
+    for (auto i = size_t{ 0 }, count = nodes_.size(); i < count; i++) {
+        if (nodes_[i].predecessorCount == 0)
+            _submit(worker, static_cast<node_id_t>(i));
+    }
+}
+
+void TaskGraph::wait()
+{
+    assert(Worker::isInWorkerThread());
+
+    Worker::threadWorker().waitFor(completion_t{ this });
+}
+
+void TaskGraph::run()
+{
+    launch();
+    wait();
+}
+
+void TaskGraph::_prepare()
+{
+    // a graph with a cycle would never be done
+    assert(std::any_of(nodes_.begin(), nodes_.end(), [](node_t const& node) -> bool {
+        return node.predecessorCount == 0;
+    }));
+
+    // only the first launch after adding nodes allocates
+    if (counterCount_ < nodes_.size()) {
+        pendingPredecessors_ = std::make_unique<std::atomic<uint32_t>[]>(nodes_.size());
+        counterCount_ = nodes_.size();
+    }
+}
+
+void TaskGraph::_submit(Worker& worker, node_id_t id)
+{
+    worker.submitDetachedTask([this, id]() -> void { _execute(id); }, priority_);
+}
+
+void TaskGraph::_execute(node_id_t id)
+{
+    while (id != invalid_node_id_v) {
+        auto const& node = nodes_[id];
+
+        if (!failed_.load(std::memory_order_relaxed)) {
+            // the coroutine finishes the node wherever it ends up, this task is over
+            if (node.coroutine) {
+                _executeCoroutine(id);
+                return;
+            }
+
+            try {
+                node.functor();
+            } catch (...) {
+                _fail(std::current_exception());
+            }
+        }
+
+        id = _finish(id);
+    }
+}
+
+auto TaskGraph::_executeCoroutine(node_id_t id) -> detached_coroutine_t
+{
+    try {
+        co_await nodes_[id].coroutine();
+    } catch (...) {
+        _fail(std::current_exception());
+    }
+
+    // successors are submitted by workers
+    co_await toWorkers();
+
+    _execute(_finish(id));
+}
+
+auto TaskGraph::_finish(node_id_t id) -> node_id_t
+{
+    auto& worker = Worker::threadWorker();
+
+    // one of the ready successors continues in this task, the others go to the own queue for thieves
+    auto next = invalid_node_id_v;
+
+    for (auto successor : nodes_[id].successors) {
+        if (pendingPredecessors_[successor].fetch_sub(1, std::memory_order_acq_rel) != 1)
+            continue;
+
+        if (next != invalid_node_id_v)
+            _submit(worker, next);
+
+        next = successor;
+    }
+
+    // the graph could be gone right after the last node is over, so nothing touches it after that
+    [[maybe_unused]] auto remaining = remaining_.fetch_sub(1, std::memory_order_acq_rel);
+    assert(remaining > 1 || next == invalid_node_id_v);
+
+    return next;
+}
+
+void TaskGraph::_fail(std::exception_ptr exception)
+{
+    if (!failed_.exchange(true, std::memory_order_relaxed))
+        exception_ = std::move(exception);
+}
+
+void TaskGraph::_rethrow() const
+{
+    assert(done());
+
+    if (exception_)
+        std::rethrow_exception(exception_);
+}
+}
@@ -0,0 +1,154 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_TASKGRAPH_H
+#define CYCLONITE_TASKGRAPH_H
+
+#include "coroutine.h"
+#include "worker.h"
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace cyclonite::multithreading {
+// nodes run as soon as all of their predecessors are over, nobody blocks on a dependency:
+// the task finishing the last predecessor submits the node to its own queue (or just continues with it)
+// the graph is built once and can be launched again after it is done, launch does not allocate
+// all nodes go to the lane of the graph priority
+// a node returning Coroutine<> is over when the coroutine is, nobody waits for it meanwhile,
+// it could hop to the render thread and back (see toRenderThread)
+class TaskGraph
+{
+public:
+    using node_id_t = uint32_t;
+
+    static constexpr node_id_t invalid_node_id_v = std::numeric_limits<node_id_t>::max();
+
+    explicit TaskGraph(TaskPriority priority = TaskPriority::NORMAL) noexcept;
+
+    TaskGraph(TaskGraph const&) = delete;
+
+    TaskGraph(TaskGraph&&) = delete;
+
+    ~TaskGraph();
+
+    auto operator=(TaskGraph const&) -> TaskGraph& = delete;
+
+    auto operator=(TaskGraph&&) -> TaskGraph& = delete;
+
+    template<TaskFunctor F>
+    auto addNode(F&& f) -> node_id_t;
+
+    // the successor starts after the predecessor is over
+    void addEdge(node_id_t predecessor, node_id_t successor);
+
+    [[nodiscard]] auto nodeCount() const -> size_t { return nodes_.size(); }
+
+    [[nodiscard]] auto priority() const -> TaskPriority { return priority_; }
+
+    // submits the nodes without predecessors, both launch and wait are for worker threads only
+    void launch();
+
+    [[nodiscard]] auto done() const -> bool { return remaining_.load(std::memory_order_acquire) == 0; }
+
+    // executes other tasks meanwhile, rethrows the first failure of the nodes,
+    // the nodes left after a failure are skipped
+    void wait();
+
+    void run();
+
+private:
+    struct node_t
+    {
+        std::function<void()> functor;
+        std::function<Coroutine<>()> coroutine;
+        std::vector<node_id_t> successors;
+        uint32_t predecessorCount;
+    };
+
+    // makes the graph look like a future for Worker::waitFor
+    struct completion_t
+    {
+        TaskGraph* graph;
+
+        [[nodiscard]] auto ready() const -> bool { return graph->done(); }
+
+        void get() const { graph->_rethrow(); }
+    };
+
+    // starts at once and destroys itself when it is over, the coroutine of a node runs in it
+    struct detached_coroutine_t
+    {
+        struct promise_type
+        {
+            static auto operator new(size_t size) -> void*
+            {
+                return internal::CoroutinePromiseBase::operator new(size);
+            }
+
+            static void operator delete(void* ptr, size_t size)
+            {
+                internal::CoroutinePromiseBase::operator delete(ptr, size);
+            }
+
+            [[nodiscard]] auto get_return_object() const noexcept -> detached_coroutine_t { return {}; }
+
+            [[nodiscard]] auto initial_suspend() const noexcept -> std::suspend_never { return {}; }
+
+            [[nodiscard]] auto final_suspend() const noexcept -> std::suspend_never { return {}; }
+
+            void return_void() const noexcept {}
+
+            // failures of the node are caught by the body
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+
+    void _prepare();
+
+    void _submit(Worker& worker, node_id_t id);
+
+    void _execute(node_id_t id);
+
+    auto _executeCoroutine(node_id_t id) -> detached_coroutine_t;
+
+    // counts the node down for its successors, the ready ones but the returned one are submitted
+    auto _finish(node_id_t id) -> node_id_t;
+
+    void _fail(std::exception_ptr exception);
+
+    void _rethrow() const;
+
+private:
+    std::vector<node_t> nodes_;
+    TaskPriority priority_;
+    std::unique_ptr<std::atomic<uint32_t>[]> pendingPredecessors_;
+    size_t counterCount_;
+    std::exception_ptr exception_;
+    std::atomic<bool> failed_;
+    std::atomic<uint32_t> remaining_;
+};
+
+template<TaskFunctor F>
+auto TaskGraph::addNode(F&& f) -> node_id_t
+{
+    assert(done());
+    assert(nodes_.size() < invalid_node_id_v);
+
+    auto id = static_cast<node_id_t>(nodes_.size());
+
+    if constexpr (std::is_same_v<std::invoke_result_t<F>, Coroutine<>>) {
+        nodes_.push_back(node_t{ {}, std::function<Coroutine<>()>{ std::forward<F>(f) }, {}, 0 });
+    } else {
+        nodes_.push_back(node_t{ std::function<void()>{ std::forward<F>(f) }, {}, {}, 0 });
+    }
+
+    return id;
+}
+}
+
+#endif // CYCLONITE_TASKGRAPH_H
@@ -7,37 +7,64 @@
 
 namespace cyclonite::multithreading {
 static constexpr auto _taskPoolSize = size_t{ 1024 };
+static constexpr auto _injectionQueueSize = size_t{ 4096 };
 
-TaskManager::TaskManager(size_t workerCount)
+TaskManager::TaskManager(size_t workerCount, IdlePolicy idlePolicy, PlacementPolicy const& placementPolicy)
   : exceptions_{}
   , threadPool_{}
   , workers_{ std::make_unique_for_overwrite<Worker[]>(workerCount) }
   , workerCount_{ workerCount }
-  , render_{ *this }
+  , injectionPool_{ _taskPoolSize }
+  , injectionQueues_{}
+  , render_{ *this, _taskPoolSize }
+  , idlePolicy_{ idlePolicy }
+  , topology_{ CpuTopology::detect() }
+  , placement_{ placementPolicy.place(topology_, workerCount) }
+  , workerParkingLot_{}
+  , renderParkingLot_{}
   , exceptionMutex_{}
   , alive_{ true }
+  , frameIndex_{ 0 }
+  , sequence_{ 0 }
 {
     for (auto i = size_t{ 0 }; i < workerCount_; i++) {
         new (&workers_[i]) Worker{ *this, _taskPoolSize };
     }
 
+    for (auto&& queue : injectionQueues_)
+        queue = std::make_unique<lock_free_mpmc_queue_t<Task*>>(_injectionQueueSize);
+
     threadPool_.reserve(workerCount_);
     threadPool_.emplace_back([](Render& render) -> void { render(); }, std::ref(render_));
 
+    // failures leave threads where the os puts them, the placement is a hint
+    if (!placement_.renderThreadCpus.empty())
+        setThreadAffinity(threadPool_.back(), placement_.renderThreadCpus);
+
+    if (!placement_.workerCpus[0].empty())
+        setCurrentThreadAffinity(placement_.workerCpus[0]);
+
     exceptions_.reserve(workerCount);
 
     workers_[0]._setAsMainThreadWorker();
+
+    CYCLONITE_TRACE_THREAD_NAME("main");
 }
 
 TaskManager::~TaskManager()
 {
     stop();
+
+    workers_[0]._resetAsMainThreadWorker();
 }
 
 void TaskManager::stop()
 {
     alive_.store(false);
 
+    workerParkingLot_.notifyAll();
+    renderParkingLot_.notifyAll();
+
     for (auto&& thread : threadPool_) {
         if (thread.joinable())
             thread.join();
@@ -50,6 +77,20 @@ void TaskManager::propagateException(std::exception_ptr const& exception)
     exceptions_.push_back(exception);
 }
 
+void TaskManager::execute(Task& task)
+{
+    CYCLONITE_ZONE_ARG("task", task.sequence());
+    CYCLONITE_TRACE_FLOW_END(task.sequence());
+
+    task();
+
+    // nobody is going to get the exception from the task
+    if (task.detached() && task.exception())
+        propagateException(task.exception());
+
+    TaskPool::release(&task);
+}
+
 auto TaskManager::getLastException() -> std::exception_ptr
 {
     std::lock_guard<std::mutex> lock{ exceptionMutex_ };
@@ -74,4 +115,63 @@ auto TaskManager::renderQueue(size_t workerIndex) -> lock_free_spmc_queue_t<Task
     assert(workerIndex < workerCount_);
     return workers_[workerIndex].renderQueue();
 }
+
+void TaskManager::_inject(Task* task)
+{
+    auto& queue = injectionQueue(task->priority());
+
+    while (!queue.tryPush(task)) {
+        workerParkingLot_.notifyAll();
+        std::this_thread::yield();
+    }
+
+    workerParkingLot_.notifyOne();
+}
+
+auto TaskManager::hasPendingTasks() const -> bool
+{
+    for (auto&& queue : injectionQueues_) {
+        if (!queue->empty())
+            return true;
+    }
+
+    for (auto i = size_t{ 0 }; i < workerCount_; i++) {
+        if (workers_[i].pendingTaskCount() > 0)
+            return true;
+    }
+
+    return !render_.queue().empty();
+}
+
+auto TaskManager::hasPendingRenderTasks() const -> bool
+{
+    for (auto i = size_t{ 0 }; i < workerCount_; i++) {
+        if (!workers_[i].renderQueue().empty())
+            return true;
+    }
+
+    return false;
+}
+
+auto TaskManager::taskPoolHighWaterMark() const -> size_t
+{
+    auto highWaterMark = size_t{ 0 };
+
+    for (auto i = size_t{ 0 }; i < workerCount_; i++) {
+        highWaterMark = std::max(highWaterMark, workers_[i].taskPoolHighWaterMark());
+    }
+
+    return highWaterMark;
+}
+
+auto TaskManager::metrics() const -> SchedulerMetrics
+{
+    auto metrics = SchedulerMetrics{ {}, render_.metrics() };
+    metrics.workers.reserve(workerCount_);
+
+    for (auto i = size_t{ 0 }; i < workerCount_; i++)
+        metrics.workers.push_back(workers_[i].metrics());
+
+    return metrics;
+}
 }
@@ -5,8 +5,14 @@
 #ifndef CYCLONITE_TASKMANAGER_H
 #define CYCLONITE_TASKMANAGER_H
 
+#include "idlePolicy.h"
+#include "internal/rangeTask.h"
+#include "parkingLot.h"
+#include "placementPolicy.h"
 #include "render.h"
 #include "worker.h"
+#include <array>
+#include <string>
 #include <thread>
 #include <type_traits>
 #include <vector>
@@ -22,7 +28,10 @@ class TaskManager
     friend class Render;
 
 public:
-    explicit TaskManager(size_t workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1u);
+    // the placement policy pins the main thread as the first worker, it keeps the affinity after that
+    explicit TaskManager(size_t workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1u,
+                         IdlePolicy idlePolicy = IdlePolicy{},
+                         PlacementPolicy const& placementPolicy = PlacementPolicy{});
 
     TaskManager(TaskManager const&) = delete;
 
@@ -38,22 +47,67 @@ public:
 
     [[nodiscard]] auto workerCount() const -> uint32_t { return workerCount_; }
 
+    [[nodiscard]] auto idlePolicy() const -> IdlePolicy const& { return idlePolicy_; }
+
+    [[nodiscard]] auto topology() const -> CpuTopology const& { return topology_; }
+
+    // cpus chosen by the placement policy
+    [[nodiscard]] auto placement() const -> ThreadPlacement const& { return placement_; }
+
+    [[nodiscard]] auto taskPoolHighWaterMark() const -> size_t;
+
+    // counters of the workers and the render thread, they are always on: every thread updates only its own ones
+    [[nodiscard]] auto metrics() const -> SchedulerMetrics;
+
     template<TaskFunctor F>
     auto start(F&& f) -> std::future<std::invoke_result_t<F>>;
 
     void stop();
 
     template<TaskFunctor F>
-    auto submitRenderTask(F&& f) -> std::future<std::invoke_result_t<F>>;
+    auto submitRenderTask(F&& f) -> Future<std::invoke_result_t<F>>;
+
+    // a worker submits to its own queue, any other thread goes through the injection queue,
+    // the task gets the priority of the current one (normal outside of tasks)
+    template<TaskFunctor F>
+    auto submitTask(F&& f) -> Future<std::invoke_result_t<F>>;
+
+    template<TaskFunctor F>
+    auto submitTask(F&& f, TaskPriority priority) -> Future<std::invoke_result_t<F>>;
+
+    template<TaskFunctor F>
+    void submitDetachedTask(F&& f);
 
     template<TaskFunctor F>
-    auto submitTask(F&& f) -> std::future<std::invoke_result_t<F>>;
+    void submitDetachedTask(F&& f, TaskPriority priority);
+
+    // frame arenas of workers are reset on the next use, the data of the last frame must be gone by now
+    void beginFrame() { frameIndex_.fetch_add(1, std::memory_order_relaxed); }
+
+    // 0 until the first frame
+    [[nodiscard]] auto frameIndex() const -> uint64_t { return frameIndex_.load(std::memory_order_relaxed); }
+
+    // calls body(from, to) for the parts of [first, last) in parallel, the parts are not less than grain
+    // (except the last one), the range is split lazily, while idle workers steal the halves
+    template<std::integral Index, typename Body>
+    void parallelFor(Index first, Index last, Index grain, Body&& body);
+
+    // the same for body(from, to) -> T, partial results are combined in the range order
+    template<std::integral Index, typename T, typename Body, typename Combine>
+    auto parallelReduce(Index first, Index last, Index grain, T identity, Body&& body, Combine&& combine) -> T;
+
+    // helps with other tasks in worker threads, blocks anywhere else
+    template<typename FutureType>
+    auto waitFor(FutureType&& future) -> decltype(future.get());
 
     auto getLastException() -> std::exception_ptr;
 
 private:
     void propagateException(std::exception_ptr const& exception);
 
+    // executes the task in place and drops the executor reference
+    void execute(Task& task);
+
     [[nodiscard]] auto workers() const -> std::unique_ptr<Worker[]> const& { return workers_; }
 
     auto workers() -> std::unique_ptr<Worker[]>& { return workers_; }
@@ -61,18 +115,52 @@ private:
     [[nodiscard]] auto renderQueue(size_t workerIndex) const -> lock_free_spmc_queue_t<Task*> const&;
     auto renderQueue(size_t workerIndex) -> lock_free_spmc_queue_t<Task*>&;
 
+    [[nodiscard]] auto injectionQueue(TaskPriority priority) const -> lock_free_mpmc_queue_t<Task*> const&
+    {
+        return *injectionQueues_[static_cast<size_t>(priority)];
+    }
+
+    auto injectionQueue(TaskPriority priority) -> lock_free_mpmc_queue_t<Task*>&
+    {
+        return *injectionQueues_[static_cast<size_t>(priority)];
+    }
+
+    // waits for a free cell while the injection queue is full
+    void _inject(Task* task);
+
+    [[nodiscard]] auto hasPendingTasks() const -> bool;
+
+    [[nodiscard]] auto hasPendingRenderTasks() const -> bool;
+
+    auto workerParkingLot() -> ParkingLot& { return workerParkingLot_; }
+
+    auto renderParkingLot() -> ParkingLot& { return renderParkingLot_; }
+
+    auto nextSequence() -> uint64_t { return sequence_.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    [[nodiscard]] auto currentSequence() const -> uint64_t { return sequence_.load(std::memory_order_relaxed); }
+
 private:
     std::vector<std::exception_ptr> exceptions_;
     std::vector<std::thread> threadPool_;
     std::unique_ptr<Worker[]> workers_;
     size_t workerCount_;
+    TaskPool injectionPool_;
+    std::array<std::unique_ptr<lock_free_mpmc_queue_t<Task*>>, task_priority_count_v> injectionQueues_;
     Render render_;
+    IdlePolicy idlePolicy_;
+    CpuTopology topology_;
+    ThreadPlacement placement_;
+    ParkingLot workerParkingLot_;
+    ParkingLot renderParkingLot_;
     std::mutex exceptionMutex_;
     std::atomic<bool> alive_;
+    std::atomic<uint64_t> frameIndex_;
+    alignas(hardware_destructive_interference_size) std::atomic<uint64_t> sequence_;
 };
 
 template<TaskFunctor F>
-auto TaskManager::submitRenderTask(F&& f) -> std::future<std::invoke_result_t<F>>
+auto TaskManager::submitRenderTask(F&& f) -> Future<std::invoke_result_t<F>>
 {
     assert(!Render::isInRenderThread());
     assert(Worker::isInWorkerThread());
@@ -85,17 +173,109 @@ auto TaskManager::start(F&& f) -> std::future<std::invoke_result_t<F>>
 {
     auto const firstWorkerThread = size_t{ 1 };
 
-    for (auto i = firstWorkerThread; i < workerCount_; i++)
-        threadPool_.emplace_back([](Worker& worker) -> void { worker(); }, std::ref(workers_[i]));
+    for (auto i = firstWorkerThread; i < workerCount_; i++) {
+        threadPool_.emplace_back(
+          [](Worker& worker, [[maybe_unused]] size_t index) -> void {
+              CYCLONITE_TRACE_THREAD_NAME("worker " + std::to_string(index));
+              worker();
+          },
+          std::ref(workers_[i]),
+          i);
 
-    // TODO:: adds ability to steal task for main thread
+        if (!placement_.workerCpus[i].empty())
+            setThreadAffinity(threadPool_.back(), placement_.workerCpus[i]);
+    }
+
+    // the main thread executes tasks of the others every time it waits for something, see Worker::waitFor
     return workers_[0](std::forward<F>(f));
 }
 
+template<typename FutureType>
+auto TaskManager::waitFor(FutureType&& future) -> decltype(future.get())
+{
+    if (Worker::isInWorkerThread())
+        return Worker::threadWorker().waitFor(std::forward<FutureType>(future));
+
+    return future.get();
+}
+
 template<TaskFunctor F>
-auto TaskManager::submitTask(F&& f) -> std::future<std::invoke_result_t<F>>
+auto TaskManager::submitTask(F&& f) -> Future<std::invoke_result_t<F>>
 {
-    return workers_[0].submitTask(std::forward<F>(f));
+    return submitTask(std::forward<F>(f), Worker::currentPriority());
+}
+
+template<TaskFunctor F>
+auto TaskManager::submitTask(F&& f, TaskPriority priority) -> Future<std::invoke_result_t<F>>
+{
+    if (Worker::isInWorkerThread())
+        return Worker::threadWorker().submitTask(std::forward<F>(f), priority);
+
+    auto* task = injectionPool_.writeableTask();
+    task->emplace(std::forward<F>(f), nextSequence(), priority);
+
+    // the future must hold the task before anybody can execute it
+    auto future = Future<std::invoke_result_t<F>>{ task };
+
+    _inject(task);
+
+    return future;
+}
+
+template<TaskFunctor F>
+void TaskManager::submitDetachedTask(F&& f)
+{
+    submitDetachedTask(std::forward<F>(f), Worker::currentPriority());
+}
+
+template<TaskFunctor F>
+void TaskManager::submitDetachedTask(F&& f, TaskPriority priority)
+{
+    if (Worker::isInWorkerThread()) {
+        Worker::threadWorker().submitDetachedTask(std::forward<F>(f), priority);
+        return;
+    }
+
+    auto* task = injectionPool_.writeableTask();
+    task->emplace(std::forward<F>(f), nextSequence(), priority);
+
+    _inject(task);
+}
+
+template<std::integral Index, typename Body>
+void TaskManager::parallelFor(Index first, Index last, Index grain, Body&& body)
+{
+    assert(grain > 0);
+
+    if (first >= last)
+        return;
+
+    // there is nobody to share the range with outside of workers
+    if (!Worker::isInWorkerThread()) {
+        body(first, last);
+        return;
+    }
+
+    using range_task_t = internal::RangeTask<Index, void, std::remove_reference_t<Body>, internal::no_combine_t>;
+
+    range_task_t{ first, last, grain, internal::eagerSplitCount(workerCount_), &body, nullptr }();
+}
+
+template<std::integral Index, typename T, typename Body, typename Combine>
+auto TaskManager::parallelReduce(Index first, Index last, Index grain, T identity, Body&& body, Combine&& combine) -> T
+{
+    assert(grain > 0);
+
+    if (first >= last)
+        return identity;
+
+    if (!Worker::isInWorkerThread())
+        return combine(std::move(identity), body(first, last));
+
+    using range_task_t = internal::RangeTask<Index, T, std::remove_reference_t<Body>, std::remove_reference_t<Combine>>;
+
+    return combine(std::move(identity),
+                   range_task_t{ first, last, grain, internal::eagerSplitCount(workerCount_), &body, &combine }());
 }
 }
 
@@ -3,27 +3,129 @@
 //
 
 #include "taskPool.h"
-#include <random>
+#include <bit>
 
 namespace cyclonite::multithreading {
+TaskPool::TaskPool() noexcept
+  : baseSize_{ 0 }
+  , chunks_{}
+  , chunkCount_{ 0 }
+  , growMutex_{}
+  , head_{ _pack(invalid_slot_v, 0) }
+  , size_{ 0 }
+  , capacity_{ 0 }
+  , highWaterMark_{ 0 }
+{
+}
+
 TaskPool::TaskPool(size_t size)
-  : size_{ size }
-  , tasks_{ std::make_unique_for_overwrite<Task[]>(size) }
+  : TaskPool{}
 {
+    assert(size > 0);
+
+    baseSize_ = size;
+    _grow();
+}
+
+auto TaskPool::_task(uint32_t slot) -> Task&
+{
+    // chunk k keeps (baseSize << k) tasks
+    auto chunkIndex = static_cast<size_t>(std::bit_width(slot / baseSize_ + 1) - 1);
+    auto offset = slot - baseSize_ * ((size_t{ 1 } << chunkIndex) - 1);
+
+    return chunks_[chunkIndex][offset];
 }
 
 auto TaskPool::writeableTask() -> Task*
 {
-    Task* taskPtr = nullptr;
-    for (auto i = size_t{ 0 }; i < size_; i++) {
-        auto& task = tasks_[i];
+    auto head = head_.load(std::memory_order_acquire);
+
+    while (true) {
+        auto slot = _slot(head);
 
-        if (!task.pending()) {
-            taskPtr = &task;
-            break;
+        if (slot == invalid_slot_v) {
+            _grow();
+            head = head_.load(std::memory_order_acquire);
+            continue;
+        }
+
+        auto& task = _task(slot);
+        auto next = task.next_.load(std::memory_order_relaxed);
+
+        if (head_.compare_exchange_weak(
+              head, _pack(next, _tag(head) + 1), std::memory_order_acquire, std::memory_order_acquire)) {
+            assert(!task.pending());
+
+            auto size = size_.fetch_add(1, std::memory_order_relaxed) + 1;
+            auto highWaterMark = highWaterMark_.load(std::memory_order_relaxed);
+
+            while (size > highWaterMark && !highWaterMark_.compare_exchange_weak(highWaterMark, size)) {
+            }
+
+            return &task;
         }
     }
+}
+
+void TaskPool::release(Task* task)
+{
+    assert(task != nullptr);
+    assert(task->pool_ != nullptr);
+
+    if (task->refCount_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    assert(!task->pending());
+
+    task->_reset();
 
-    return taskPtr;
+    auto* pool = task->pool_;
+
+    task->generation_.fetch_add(1, std::memory_order_release);
+
+    pool->size_.fetch_sub(1, std::memory_order_relaxed);
+    pool->_push(task, task);
+}
+
+void TaskPool::_push(Task* first, Task* last)
+{
+    auto head = head_.load(std::memory_order_relaxed);
+
+    do {
+        last->next_.store(_slot(head), std::memory_order_relaxed);
+    } while (!head_.compare_exchange_weak(
+      head, _pack(first->slot_, _tag(head) + 1), std::memory_order_release, std::memory_order_relaxed));
+}
+
+void TaskPool::_grow()
+{
+    std::lock_guard<std::mutex> lock{ growMutex_ };
+
+    // somebody has already grown the pool or returned a task
+    if (_slot(head_.load(std::memory_order_acquire)) != invalid_slot_v)
+        return;
+
+    assert(baseSize_ > 0);
+    assert(chunkCount_ < max_chunk_count_v);
+
+    auto chunkSize = baseSize_ << chunkCount_;
+    auto firstSlot = baseSize_ * ((size_t{ 1 } << chunkCount_) - 1);
+
+    assert(firstSlot + chunkSize < invalid_slot_v);
+
+    auto& chunk = chunks_[chunkCount_++];
+    chunk = std::make_unique<Task[]>(chunkSize);
+
+    for (auto i = size_t{ 0 }; i < chunkSize; i++) {
+        auto& task = chunk[i];
+
+        task.pool_ = this;
+        task.slot_ = static_cast<uint32_t>(firstSlot + i);
+        task.next_.store(static_cast<uint32_t>(firstSlot + i + 1), std::memory_order_relaxed);
+    }
+
+    capacity_.fetch_add(chunkSize, std::memory_order_relaxed);
+
+    _push(&chunk[0], &chunk[chunkSize - 1]);
+}
 }
-}
\ No newline at end of file
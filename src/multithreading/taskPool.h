@@ -6,34 +6,76 @@
 #define CYCLONITE_TASKPOOL_H
 
 #include "task.h"
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 
 namespace cyclonite::multithreading {
 class TaskManager;
 
+// lock-free free list of task slots
+// any thread can give the slot back (a thief completes the task of another worker)
+// the list head is tagged with generation to avoid ABA, the pool grows by chunks and never relocates tasks
 class TaskPool
 {
+    static constexpr size_t max_chunk_count_v = 20;
+    static constexpr uint32_t invalid_slot_v = std::numeric_limits<uint32_t>::max();
+
 public:
-    TaskPool() = default;
+    TaskPool() noexcept;
 
     explicit TaskPool(size_t size);
 
     TaskPool(TaskPool const&) = delete;
 
-    TaskPool(TaskPool&&) = default;
+    TaskPool(TaskPool&&) = delete;
 
     ~TaskPool() = default;
 
     auto operator=(TaskPool const&) -> TaskPool& = delete;
 
-    auto operator=(TaskPool&&) -> TaskPool& = default;
+    auto operator=(TaskPool&&) -> TaskPool& = delete;
 
+    // O(1), never returns nullptr, grows the pool if there is no free slot
     auto writeableTask() -> Task*;
 
+    // drops the reference, the last one returns the slot to the pool it was taken from
+    static void release(Task* task);
+
+    [[nodiscard]] auto capacity() const -> size_t { return capacity_.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] auto size() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] auto highWaterMark() const -> size_t { return highWaterMark_.load(std::memory_order_relaxed); }
+
 private:
-    size_t size_;
-    std::unique_ptr<Task[]> tasks_;
+    static auto _pack(uint32_t slot, uint32_t tag) -> uint64_t
+    {
+        return static_cast<uint64_t>(slot) | (static_cast<uint64_t>(tag) << 32);
+    }
+
+    static auto _slot(uint64_t head) -> uint32_t { return static_cast<uint32_t>(head & 0xffffffffUL); }
+
+    static auto _tag(uint64_t head) -> uint32_t { return static_cast<uint32_t>(head >> 32); }
+
+    auto _task(uint32_t slot) -> Task&;
+
+    void _push(Task* first, Task* last);
+
+    void _grow();
+
+private:
+    size_t baseSize_;
+    std::array<std::unique_ptr<Task[]>, max_chunk_count_v> chunks_;
+    size_t chunkCount_;
+    std::mutex growMutex_;
+
+    alignas(hardware_destructive_interference_size) std::atomic<uint64_t> head_;
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> size_;
+    std::atomic<size_t> capacity_;
+    std::atomic<size_t> highWaterMark_;
 };
 }
 
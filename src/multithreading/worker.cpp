@@ -5,11 +5,23 @@
 #include "worker.h"
 #include "internal/utils.h"
 #include "taskManager.h"
+#include <algorithm>
 
 namespace cyclonite::multithreading {
 static thread_local Worker* _mainThreadWorker = nullptr;
 static thread_local Worker* _threadWorker = nullptr;
 
+// the oldest task on the stack of the thread and the submission sequence when the innermost one started
+static thread_local uint64_t _oldestTaskSequence = std::numeric_limits<uint64_t>::max();
+static thread_local uint64_t _currentTaskTicket = std::numeric_limits<uint64_t>::max();
+static thread_local TaskPriority _currentTaskPriority = TaskPriority::NORMAL;
+
+// a thief takes up to a half of the victim queue, but not more than that
+static constexpr auto _maxStealBatchSize = size_t{ 16 };
+
+// a lane passed over so many times in a row goes first once, so background work is never starved for long
+static constexpr auto _starvationLimit = uint32_t{ 64 };
+
 auto Worker::threadWorker() -> Worker&
 {
     assert(_threadWorker);
@@ -26,35 +38,249 @@ auto Worker::isInMainThread() -> bool
     return _mainThreadWorker;
 }
 
+auto Worker::currentPriority() -> TaskPriority
+{
+    return _currentTaskPriority;
+}
+
+auto Worker::currentFrameArena() -> FrameArena*
+{
+    if (!isInWorkerThread() || threadWorker().taskManager().frameIndex() == 0)
+        return nullptr;
+
+    return &threadWorker().frameArena();
+}
+
 Worker::Worker(TaskManager& taskManager, size_t size)
   : threadId_{}
   , taskManager_{ &taskManager }
   , taskPool_{ size * 2 }
-  , workerQueue_{ nullptr }
+  , workerQueues_{}
   , renderQueue_{ nullptr }
+  , passedOver_{}
+  , frameArena_{}
+  , frameArenaFrame_{ 0 }
+  , executedTasks_{}
+  , localPops_{}
+  , injectedPops_{}
+  , stealAttempts_{}
+  , steals_{}
+  , stolenTasks_{}
+  , idleNanoseconds_{}
+  , waitingNanoseconds_{}
 {
-    workerQueue_ = std::make_unique<lock_free_spmc_queue_t<Task*>>(size);
+    for (auto&& queue : workerQueues_)
+        queue = std::make_unique<lock_free_spmc_queue_t<Task*>>(size);
+
     renderQueue_ = std::make_unique<lock_free_spmc_queue_t<Task*>>(size);
 }
 
-auto Worker::pendingTask() -> std::optional<Task>
+auto Worker::pendingTask(TaskFilter const& filter) -> Task*
+{
+    // a waiting task keeps the strict order, the lanes below could hold back the one it waits for
+    if (filter.olderThan == std::numeric_limits<uint64_t>::max()) {
+        for (auto i = task_priority_count_v; i-- > 1;) {
+            if (passedOver_[i] < _starvationLimit)
+                continue;
+
+            auto priority = static_cast<TaskPriority>(i);
+
+            if (auto* task = _pendingTask(priority, filter)) {
+                _taken(priority);
+                return task;
+            }
+
+            // nothing to starve
+            passedOver_[i] = 0;
+        }
+    }
+
+    for (auto i = size_t{ 0 }; i < task_priority_count_v; i++) {
+        auto priority = static_cast<TaskPriority>(i);
+
+        if (auto* task = _pendingTask(priority, filter)) {
+            _taken(priority);
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+auto Worker::_pendingTask(TaskPriority priority, TaskFilter const& filter) -> Task*
 {
-    auto task = std::optional<Task>{ std::nullopt };
+    auto acceptOwn = [&filter](Task* t) -> bool {
+        auto sequence = t->sequence();
+        return sequence < filter.olderThan || sequence > filter.ownNewerThan;
+    };
 
-    if (auto taskPointer = queue().popBottom()) {
-        task = std::move(*taskPointer.value());
-    } else {
-        auto workerCount = taskManager().workerCount();
-        auto workerIndex = internal::randomWorkerIndex(workerCount);
-        auto& workers = taskManager().workers();
-        auto& worker = workers[workerIndex];
+    if (auto taskPointer = queue(priority).popBottom(acceptOwn)) {
+        localPops_.add(1);
+        return taskPointer.value();
+    }
 
-        if (auto stolenTaskPtr = worker.queue().steal()) {
-            task = std::move(*stolenTaskPtr.value());
+    // tasks of other threads, they are taken only outside of tasks:
+    // the queue can not give the task back if the filter rejects it
+    if (filter.olderThan == std::numeric_limits<uint64_t>::max()) {
+        if (auto taskPointer = taskManager().injectionQueue(priority).tryPop()) {
+            injectedPops_.add(1);
+            return taskPointer.value();
         }
     }
 
-    return task;
+    // starts from a random victim to spread the thieves, but sweeps all of them before giving up
+    auto workerCount = taskManager().workerCount();
+    auto& workers = taskManager().workers();
+    auto firstVictim = internal::randomWorkerIndex(workerCount);
+
+    for (auto i = size_t{ 0 }; i < workerCount; i++) {
+        auto& worker = workers[(firstVictim + i) % workerCount];
+
+        if (&worker == this || worker.queue(priority).empty())
+            continue;
+
+        if (auto* task = _steal(worker.queue(priority), priority, filter))
+            return task;
+    }
+
+    if (priority != TaskPriority::FRAME_CRITICAL)
+        return nullptr;
+
+    // tasks handed over by the render thread, see Render::submitDetachedTask
+    auto& renderThreadQueue = taskManager().render_.queue();
+
+    return renderThreadQueue.empty() ? nullptr : _steal(renderThreadQueue, priority, filter);
+}
+
+auto Worker::_steal(lock_free_spmc_queue_t<Task*>& victim, TaskPriority priority, TaskFilter const& filter) -> Task*
+{
+    // moved tasks keep their sequence, so the own queue filter treats them as stolen ones
+    auto accept = [&filter](Task* t) -> bool { return t->sequence() < filter.olderThan; };
+
+    auto movedCount = uint64_t{ 0 };
+    auto taskPointer = victim.stealBatch(
+      accept,
+      [this, priority, &movedCount](Task* task) -> void {
+          queue(priority).emplaceBottom(task);
+          movedCount++;
+      },
+      _maxStealBatchSize);
+
+    stealAttempts_.add(1);
+
+    if (!taskPointer)
+        return nullptr;
+
+    steals_.add(1);
+    stolenTasks_.add(movedCount + 1);
+
+    // the rest of the batch is for thieves as well
+    if (movedCount > 0)
+        _notifyWorkers();
+
+    return taskPointer.value();
+}
+
+void Worker::_taken(TaskPriority priority)
+{
+    auto lane = static_cast<size_t>(priority);
+
+    passedOver_[lane] = 0;
+
+    for (auto i = lane + 1; i < task_priority_count_v; i++)
+        passedOver_[i]++;
+}
+
+auto Worker::pendingTaskCount() const -> size_t
+{
+    auto count = size_t{ 0 };
+
+    for (auto&& queue : workerQueues_)
+        count += queue->size();
+
+    return count;
+}
+
+auto Worker::metrics() const -> ThreadMetrics
+{
+    auto maxQueueDepth = size_t{ 0 };
+
+    for (auto&& queue : workerQueues_)
+        maxQueueDepth = std::max(maxQueueDepth, queue->maxSize());
+
+    return ThreadMetrics{ executedTasks_.load(),
+                          localPops_.load(),
+                          injectedPops_.load(),
+                          stealAttempts_.load(),
+                          steals_.load(),
+                          stolenTasks_.load(),
+                          idleNanoseconds_.load(),
+                          waitingNanoseconds_.load(),
+                          maxQueueDepth,
+                          taskPool_.size(),
+                          taskPool_.capacity(),
+                          taskPool_.highWaterMark() };
+}
+
+auto Worker::_runPendingTask() -> bool
+{
+    auto* task = pendingTask(TaskFilter{ _oldestTaskSequence, _currentTaskTicket });
+
+    if (task == nullptr)
+        return false;
+
+    _execute(*task);
+
+    return true;
+}
+
+void Worker::_execute(Task& task)
+{
+    auto oldestTaskSequence = _oldestTaskSequence;
+    auto currentTaskTicket = _currentTaskTicket;
+    auto currentTaskPriority = _currentTaskPriority;
+
+    _oldestTaskSequence = std::min(oldestTaskSequence, task.sequence());
+    _currentTaskTicket = taskManager().currentSequence();
+    _currentTaskPriority = task.priority();
+
+    taskManager().execute(task);
+    executedTasks_.add(1);
+
+    _oldestTaskSequence = oldestTaskSequence;
+    _currentTaskTicket = currentTaskTicket;
+    _currentTaskPriority = currentTaskPriority;
+}
+
+void Worker::_yield()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::this_thread::yield();
+
+    auto waitingTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    waitingNanoseconds_.add(static_cast<uint64_t>(waitingTime.count()));
+}
+
+auto Worker::_nextSequence() -> uint64_t
+{
+    return taskManager().nextSequence();
+}
+
+auto Worker::frameArena() -> FrameArena&
+{
+    assert(isInWorkerThread() && &threadWorker() == this);
+
+    // the reset waits for spilled functors and coroutines of the last frame
+    if (auto frame = taskManager().frameIndex(); frameArenaFrame_ != frame && frameArena_.reset())
+        frameArenaFrame_ = frame;
+
+    return frameArena_;
+}
+
+auto Worker::_functorArena(TaskPriority priority) -> FrameArena*
+{
+    return priority == TaskPriority::FRAME_CRITICAL ? currentFrameArena() : nullptr;
 }
 
 void Worker::operator()()
@@ -71,11 +297,13 @@ void Worker::operator()()
 #endif
 
     try {
+        auto idler = Idler{ taskManager().idlePolicy(), taskManager().workerParkingLot(), &idleNanoseconds_ };
+
         while (taskManager().keepAlive()) {
-            if (auto task = pendingTask()) {
-                task.value()();
+            if (_runPendingTask()) {
+                idler.reset();
             } else {
-                std::this_thread::yield();
+                idler.idle([this]() -> bool { return taskManager().hasPendingTasks() || !taskManager().keepAlive(); });
             }
         }
     } catch (...) {
@@ -112,4 +340,23 @@ void Worker::_setAsMainThreadWorker()
 
     threadId_ = std::this_thread::get_id();
 }
-}
\ No newline at end of file
+
+void Worker::_resetAsMainThreadWorker()
+{
+    if (_mainThreadWorker != this)
+        return;
+
+    _mainThreadWorker = nullptr;
+    _threadWorker = nullptr;
+}
+
+void Worker::_notifyWorkers()
+{
+    taskManager().workerParkingLot().notifyOne();
+}
+
+void Worker::_notifyRender()
+{
+    taskManager().renderParkingLot().notifyOne();
+}
+}
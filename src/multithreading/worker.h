@@ -5,9 +5,14 @@
 #ifndef CYCLONITE_WORKER_H
 #define CYCLONITE_WORKER_H
 
+#include "frameArena.h"
+#include "future.h"
 #include "lockFreeQueue.h"
+#include "schedulerMetrics.h"
 #include "task.h"
 #include "taskPool.h"
+#include <array>
+#include <chrono>
 #include <future>
 #include <thread>
 #include <type_traits>
@@ -27,29 +32,60 @@ public:
 
     Worker(Worker const&) = delete;
 
-    Worker(Worker&&) noexcept = default;
+    Worker(Worker&&) = delete;
 
     ~Worker() = default;
 
     auto operator=(Worker const&) -> Worker& = delete;
 
-    auto operator=(Worker&&) noexcept -> Worker& = default;
+    auto operator=(Worker&&) -> Worker& = delete;
 
     void operator()();
 
     template<TaskFunctor F>
     auto operator()(F&& f) -> std::future<std::invoke_result_t<F>>;
 
+    // the task gets the priority of the current one, see currentPriority()
     template<TaskFunctor F>
-    auto submitTask(F&& f) -> std::future<std::invoke_result_t<F>>;
+    auto submitTask(F&& f) -> Future<std::invoke_result_t<F>>;
 
     template<TaskFunctor F>
-    auto submitRenderTask(F&& f) -> std::future<std::invoke_result_t<F>>;
+    auto submitTask(F&& f, TaskPriority priority) -> Future<std::invoke_result_t<F>>;
+
+    // fire and forget, failures are propagated to the task manager
+    template<TaskFunctor F>
+    void submitDetachedTask(F&& f);
+
+    template<TaskFunctor F>
+    void submitDetachedTask(F&& f, TaskPriority priority);
+
+    template<TaskFunctor F>
+    auto submitRenderTask(F&& f) -> Future<std::invoke_result_t<F>>;
+
+    template<TaskFunctor F>
+    void submitDetachedRenderTask(F&& f);
+
+    // waits until the future is ready, executes pending tasks meanwhile instead of blocking the thread
+    // inside of a task it takes only tasks which can not depend on the ones down the stack:
+    // submitted before all of them or submitted to the own queue by the current one
+    template<typename FutureType>
+    auto waitFor(FutureType&& future) -> decltype(future.get());
 
     [[nodiscard]] auto threadId() const -> std::thread::id { return threadId_; }
 
     [[nodiscard]] auto canSubmit() const -> bool;
 
+    [[nodiscard]] auto pendingTaskCount() const -> size_t;
+
+    [[nodiscard]] auto taskPoolHighWaterMark() const -> size_t { return taskPool_.highWaterMark(); }
+
+    // a snapshot of the counters, it could be taken from any thread
+    [[nodiscard]] auto metrics() const -> ThreadMetrics;
+
+    // scratch memory of the current frame, it is reset by the first call after TaskManager::beginFrame,
+    // for the owner thread only
+    auto frameArena() -> FrameArena&;
+
     [[nodiscard]] auto taskManager() const -> TaskManager const& { return *taskManager_; }
     auto taskManager() -> TaskManager& { return *taskManager_; }
 
@@ -59,17 +95,58 @@ public:
 
     static auto threadWorker() -> Worker&;
 
+    // priority of the task executed by the current thread, normal outside of tasks
+    static auto currentPriority() -> TaskPriority;
+
+    // the frame arena of the current worker while frames go (see TaskManager::beginFrame), nullptr otherwise
+    static auto currentFrameArena() -> FrameArena*;
+
 private:
     [[nodiscard]] auto pool() const -> TaskPool const& { return taskPool_; }
     auto pool() -> TaskPool& { return taskPool_; }
 
-    [[nodiscard]] auto queue() const -> lock_free_spmc_queue_t<Task*> const& { return *workerQueue_; }
-    auto queue() -> lock_free_spmc_queue_t<Task*>& { return *workerQueue_; }
+    [[nodiscard]] auto queue(TaskPriority priority) const -> lock_free_spmc_queue_t<Task*> const&
+    {
+        return *workerQueues_[static_cast<size_t>(priority)];
+    }
+
+    auto queue(TaskPriority priority) -> lock_free_spmc_queue_t<Task*>&
+    {
+        return *workerQueues_[static_cast<size_t>(priority)];
+    }
 
     [[nodiscard]] auto renderQueue() const -> lock_free_spmc_queue_t<Task*> const& { return *renderQueue_; }
     auto renderQueue() -> lock_free_spmc_queue_t<Task*>& { return *renderQueue_; }
 
-    auto pendingTask() -> std::optional<Task>;
+    // a task is accepted if it was submitted before the sequence or it is in the own queue
+    // and was submitted after the own sequence
+    struct TaskFilter
+    {
+        uint64_t olderThan;
+        uint64_t ownNewerThan;
+    };
+
+    // lanes go in the priority order, but a lane passed over for too long goes first once
+    auto pendingTask(TaskFilter const& filter) -> Task*;
+
+    auto _pendingTask(TaskPriority priority, TaskFilter const& filter) -> Task*;
+
+    // takes a batch from the victim, the first task is returned, the others go to the own queue of the lane
+    auto _steal(lock_free_spmc_queue_t<Task*>& victim, TaskPriority priority, TaskFilter const& filter) -> Task*;
+
+    void _taken(TaskPriority priority);
+
+    auto _runPendingTask() -> bool;
+
+    // waitFor has nothing to help with
+    void _yield();
+
+    void _execute(Task& task);
+
+    auto _nextSequence() -> uint64_t;
+
+    // frame-critical functors which do not fit the task go to the frame arena, they are over by the end of the frame
+    auto _functorArena(TaskPriority priority) -> FrameArena*;
 
     void _setThreadWorkerPtr();
 
@@ -77,56 +154,129 @@ private:
 
     void _setAsMainThreadWorker();
 
+    void _resetAsMainThreadWorker();
+
+    void _notifyWorkers();
+
+    void _notifyRender();
+
 private:
     std::thread::id threadId_;
     TaskManager* taskManager_;
     TaskPool taskPool_;
-    std::unique_ptr<lock_free_spmc_queue_t<Task*>> workerQueue_;
+    std::array<std::unique_ptr<lock_free_spmc_queue_t<Task*>>, task_priority_count_v> workerQueues_;
     std::unique_ptr<lock_free_spmc_queue_t<Task*>> renderQueue_;
+
+    // tasks taken from the lanes above since the last one taken from the lane, owner only
+    std::array<uint32_t, task_priority_count_v> passedOver_;
+
+    FrameArena frameArena_;
+    uint64_t frameArenaFrame_;
+
+    internal::MetricCounter executedTasks_;
+    internal::MetricCounter localPops_;
+    internal::MetricCounter injectedPops_;
+    internal::MetricCounter stealAttempts_;
+    internal::MetricCounter steals_;
+    internal::MetricCounter stolenTasks_;
+    internal::MetricCounter idleNanoseconds_;
+    internal::MetricCounter waitingNanoseconds_;
 };
 
 template<TaskFunctor F>
-auto Worker::submitTask(F&& f) -> std::future<std::invoke_result_t<F>>
+auto Worker::submitTask(F&& f) -> Future<std::invoke_result_t<F>>
 {
-    assert(canSubmit());
+    return submitTask(std::forward<F>(f), currentPriority());
+}
 
-    using result_type_t = std::invoke_result_t<F>;
+template<TaskFunctor F>
+auto Worker::submitTask(F&& f, TaskPriority priority) -> Future<std::invoke_result_t<F>>
+{
+    assert(canSubmit());
 
-    Task* task = nullptr;
-    while ((task = pool().writeableTask(), task == nullptr))
-        std::this_thread::yield();
+    auto* task = pool().writeableTask();
+    task->emplace(std::forward<F>(f), _nextSequence(), priority, _functorArena(priority));
 
-    auto&& packedTask = std::packaged_task<result_type_t()>{ std::forward<F>(f) };
-    auto future = packedTask.get_future();
+    // the future must hold the task before anybody can execute it
+    auto future = Future<std::invoke_result_t<F>>{ task };
 
-    *task = Task{ std::move(packedTask) };
+    queue(priority).emplaceBottom(task);
 
-    queue().emplaceBottom(task);
+    _notifyWorkers();
 
     return future;
 }
 
 template<TaskFunctor F>
-auto Worker::submitRenderTask(F&& f) -> std::future<std::invoke_result_t<F>>
+void Worker::submitDetachedTask(F&& f)
+{
+    submitDetachedTask(std::forward<F>(f), currentPriority());
+}
+
+template<TaskFunctor F>
+void Worker::submitDetachedTask(F&& f, TaskPriority priority)
 {
     assert(canSubmit());
 
-    using result_type_t = std::invoke_result_t<F>;
+    auto* task = pool().writeableTask();
+    task->emplace(std::forward<F>(f), _nextSequence(), priority, _functorArena(priority));
+
+    queue(priority).emplaceBottom(task);
 
-    Task* task = nullptr;
-    while ((task = pool().writeableTask(), task == nullptr))
-        std::this_thread::yield();
+    _notifyWorkers();
+}
+
+template<TaskFunctor F>
+auto Worker::submitRenderTask(F&& f) -> Future<std::invoke_result_t<F>>
+{
+    assert(canSubmit());
 
-    auto&& packedTask = std::packaged_task<result_type_t()>{ std::forward<F>(f) };
-    auto future = packedTask.get_future();
+    auto* task = pool().writeableTask();
+    task->emplace(std::forward<F>(f), _nextSequence(), TaskPriority::FRAME_CRITICAL);
 
-    *task = Task{ std::move(packedTask) };
+    auto future = Future<std::invoke_result_t<F>>{ task };
 
     renderQueue().emplaceBottom(task);
 
+    _notifyRender();
+
     return future;
 }
 
+template<TaskFunctor F>
+void Worker::submitDetachedRenderTask(F&& f)
+{
+    assert(canSubmit());
+
+    auto* task = pool().writeableTask();
+    task->emplace(std::forward<F>(f), _nextSequence(), TaskPriority::FRAME_CRITICAL);
+
+    renderQueue().emplaceBottom(task);
+
+    _notifyRender();
+}
+
+template<typename FutureType>
+auto Worker::waitFor(FutureType&& future) -> decltype(future.get())
+{
+    assert(isInWorkerThread() && &threadWorker() == this);
+
+    auto ready = [&future]() -> bool {
+        if constexpr (requires { future.ready(); }) {
+            return future.ready();
+        } else {
+            return future.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready;
+        }
+    };
+
+    while (!ready()) {
+        if (!_runPendingTask())
+            _yield();
+    }
+
+    return future.get();
+}
+
 template<TaskFunctor F>
 auto Worker::operator()(F&& f) -> std::future<std::invoke_result_t<F>>
 {
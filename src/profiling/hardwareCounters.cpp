@@ -0,0 +1,279 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "hardwareCounters.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace cyclonite::profiling {
+std::atomic<bool> HardwareCounters::enabled_{ false };
+
+namespace {
+struct accumulator_t
+{
+    char const* name;
+    uint64_t arg;
+    uint64_t calls;
+    HardwareCounts counts;
+};
+
+// counters are a group, one read gets all of them
+struct thread_counters_t
+{
+    thread_counters_t()
+      : mutex{}
+      , accumulators{}
+      , descriptors{}
+      , slots{}
+      , leader{ -1 }
+      , opened{ 0 }
+    {
+        descriptors.fill(-1);
+        slots.fill(-1);
+    }
+
+    std::mutex mutex; // the owner adds under it, snapshots read under it
+    std::vector<accumulator_t> accumulators;
+    std::array<int, hardware_event_count_v> descriptors;
+    std::array<int, hardware_event_count_v> slots; // a position in the group read, -1 is not counted
+    int leader;
+    size_t opened;
+};
+
+struct registry_t
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<thread_counters_t>> threads;
+};
+
+// the counters are closed with the thread, the accumulated counts stay in the registry
+struct thread_handle_t
+{
+    thread_counters_t* counters = nullptr;
+
+    ~thread_handle_t();
+};
+}
+
+static auto _registry() -> registry_t&
+{
+    static auto registry = registry_t{};
+    return registry;
+}
+
+static thread_local thread_handle_t _thread = {};
+
+#if defined(__linux__)
+static auto _eventAttributes(HardwareEvent event) -> perf_event_attr
+{
+    auto attributes = perf_event_attr{};
+
+    attributes.size = sizeof(attributes);
+    attributes.read_format = PERF_FORMAT_GROUP;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.type = PERF_TYPE_HARDWARE;
+
+    switch (event) {
+        case HardwareEvent::CYCLES:
+            attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case HardwareEvent::INSTRUCTIONS:
+            attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case HardwareEvent::L1D_READ_MISSES:
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case HardwareEvent::LLC_MISSES:
+            attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case HardwareEvent::BRANCH_MISSES:
+            attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            assert(false);
+    }
+
+    return attributes;
+}
+
+static void _open(thread_counters_t& counters)
+{
+    for (auto i = size_t{ 0 }; i < hardware_event_count_v; i++) {
+        auto attributes = _eventAttributes(static_cast<HardwareEvent>(i));
+
+        // this thread on any cpu
+        auto descriptor = static_cast<int>(syscall(
+          SYS_perf_event_open, &attributes, 0, -1, counters.leader, static_cast<unsigned long>(PERF_FLAG_FD_CLOEXEC)));
+
+        if (descriptor < 0)
+            continue;
+
+        if (counters.leader < 0)
+            counters.leader = descriptor;
+
+        counters.descriptors[i] = descriptor;
+        counters.slots[i] = static_cast<int>(counters.opened++);
+    }
+}
+
+static void _close(thread_counters_t& counters)
+{
+    // the leader goes last, it holds the group
+    for (auto descriptor : counters.descriptors) {
+        if (descriptor >= 0 && descriptor != counters.leader)
+            close(descriptor);
+    }
+
+    if (counters.leader >= 0)
+        close(counters.leader);
+
+    counters.descriptors.fill(-1);
+    counters.slots.fill(-1);
+    counters.leader = -1;
+    counters.opened = 0;
+}
+
+static auto _read(thread_counters_t const& counters) -> HardwareCounts
+{
+    auto counts = HardwareCounts{};
+
+    if (counters.leader < 0)
+        return counts;
+
+    // the number of events and the values in the order they were opened
+    auto buffer = std::array<uint64_t, hardware_event_count_v + 1>{};
+    auto size = static_cast<ssize_t>(sizeof(uint64_t) * (counters.opened + 1));
+
+    if (::read(counters.leader, buffer.data(), static_cast<size_t>(size)) != size)
+        return counts;
+
+    for (auto i = size_t{ 0 }; i < hardware_event_count_v; i++) {
+        if (counters.slots[i] >= 0)
+            counts.values[i] = buffer[1 + static_cast<size_t>(counters.slots[i])];
+    }
+
+    return counts;
+}
+#else
+static void _open(thread_counters_t&) {}
+
+static void _close(thread_counters_t&) {}
+
+static auto _read(thread_counters_t const&) -> HardwareCounts
+{
+    return HardwareCounts{};
+}
+#endif
+
+thread_handle_t::~thread_handle_t()
+{
+    if (counters != nullptr)
+        _close(*counters);
+}
+
+static auto _threadCounters() -> thread_counters_t&
+{
+    if (_thread.counters == nullptr) {
+        auto& registry = _registry();
+        auto lock = std::lock_guard{ registry.mutex };
+
+        _thread.counters = registry.threads.emplace_back(std::make_unique<thread_counters_t>()).get();
+        _open(*_thread.counters);
+    }
+
+    return *_thread.counters;
+}
+
+void HardwareCounters::start()
+{
+    clear();
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void HardwareCounters::stop()
+{
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+auto HardwareCounters::available(HardwareEvent event) -> bool
+{
+    return _threadCounters().slots[static_cast<size_t>(event)] >= 0;
+}
+
+auto HardwareCounters::read() -> HardwareCounts
+{
+    return _read(_threadCounters());
+}
+
+void HardwareCounters::add(char const* name, uint64_t arg, HardwareCounts const& counts)
+{
+    auto& counters = _threadCounters();
+    auto lock = std::lock_guard{ counters.mutex };
+
+    auto it = std::find_if(counters.accumulators.begin(), counters.accumulators.end(), [&](auto&& accumulator) -> bool {
+        return accumulator.name == name && accumulator.arg == arg;
+    });
+
+    if (it == counters.accumulators.end())
+        it = counters.accumulators.insert(it, accumulator_t{ name, arg, 0, HardwareCounts{} });
+
+    it->calls++;
+    it->counts += counts;
+}
+
+auto HardwareCounters::snapshot() -> std::vector<HardwareCounterSample>
+{
+    auto samples = std::vector<HardwareCounterSample>{};
+
+    auto& registry = _registry();
+    auto registryLock = std::lock_guard{ registry.mutex };
+
+    // the same literal could have different addresses in different translation units
+    auto less = [](auto&& lhs, auto&& rhs) -> bool {
+        auto order = std::strcmp(lhs.name, rhs.name);
+        return order < 0 || (order == 0 && lhs.arg < rhs.arg);
+    };
+
+    for (auto&& counters : registry.threads) {
+        auto lock = std::lock_guard{ counters->mutex };
+
+        for (auto&& [name, arg, calls, counts] : counters->accumulators) {
+            auto sample = HardwareCounterSample{ name, arg, calls, counts };
+            auto it = std::lower_bound(samples.begin(), samples.end(), sample, less);
+
+            if (it != samples.end() && !less(sample, *it)) {
+                it->calls += calls;
+                it->counts += counts;
+            } else {
+                samples.insert(it, sample);
+            }
+        }
+    }
+
+    return samples;
+}
+
+void HardwareCounters::clear()
+{
+    auto& registry = _registry();
+    auto registryLock = std::lock_guard{ registry.mutex };
+
+    for (auto&& counters : registry.threads) {
+        auto lock = std::lock_guard{ counters->mutex };
+        counters->accumulators.clear();
+    }
+}
+}
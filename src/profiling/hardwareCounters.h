@@ -0,0 +1,147 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_HARDWARECOUNTERS_H
+#define CYCLONITE_HARDWARECOUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cyclonite::profiling {
+enum class HardwareEvent : uint8_t
+{
+    CYCLES = 0,
+    INSTRUCTIONS = 1,
+    L1D_READ_MISSES = 2,
+    LLC_MISSES = 3,
+    BRANCH_MISSES = 4,
+    MIN_VALUE = CYCLES,
+    MAX_VALUE = BRANCH_MISSES,
+    COUNT = MAX_VALUE + 1
+};
+
+static constexpr size_t hardware_event_count_v = static_cast<size_t>(HardwareEvent::COUNT);
+
+struct HardwareCounts
+{
+    std::array<uint64_t, hardware_event_count_v> values;
+
+    [[nodiscard]] auto operator[](HardwareEvent event) const -> uint64_t
+    {
+        return values[static_cast<size_t>(event)];
+    }
+
+    auto operator+=(HardwareCounts const& rhs) -> HardwareCounts&
+    {
+        for (auto i = size_t{ 0 }; i < hardware_event_count_v; i++)
+            values[i] += rhs.values[i];
+
+        return *this;
+    }
+
+    auto operator-=(HardwareCounts const& rhs) -> HardwareCounts&
+    {
+        for (auto i = size_t{ 0 }; i < hardware_event_count_v; i++)
+            values[i] -= rhs.values[i];
+
+        return *this;
+    }
+};
+
+// counts of a scope over all of the threads, arg tells apart instances (e.g. node ids)
+struct HardwareCounterSample
+{
+    char const* name;
+    uint64_t arg;
+    uint64_t calls;
+    HardwareCounts counts;
+};
+
+// per thread perf_event_open counters (linux only), a thread opens its counter group on the first scope
+// after start, the events the kernel refuses (no pmu in a vm, perf_event_paranoid) stay zero,
+// user space only, scopes are inclusive (a nested scope is counted by the outer one as well)
+class HardwareCounters
+{
+public:
+    static void start();
+
+    static void stop();
+
+    [[nodiscard]] static auto enabled() -> bool { return enabled_.load(std::memory_order_relaxed); }
+
+    // whether the event is counted on the calling thread
+    [[nodiscard]] static auto available(HardwareEvent event) -> bool;
+
+    // totals of the calling thread, every read is a syscall
+    [[nodiscard]] static auto read() -> HardwareCounts;
+
+    static void add(char const* name, uint64_t arg, HardwareCounts const& counts);
+
+    // sorted by name and arg
+    [[nodiscard]] static auto snapshot() -> std::vector<HardwareCounterSample>;
+
+    static void clear();
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+class HardwareCounterScope
+{
+public:
+    explicit HardwareCounterScope(char const* name, uint64_t arg = 0)
+      : name_{ HardwareCounters::enabled() ? name : nullptr }
+      , arg_{ arg }
+      , begin_{}
+    {
+        if (name_ != nullptr)
+            begin_ = HardwareCounters::read();
+    }
+
+    HardwareCounterScope(HardwareCounterScope const&) = delete;
+
+    HardwareCounterScope(HardwareCounterScope&&) = delete;
+
+    ~HardwareCounterScope()
+    {
+        if (name_ != nullptr) {
+            auto counts = HardwareCounters::read();
+            counts -= begin_;
+
+            HardwareCounters::add(name_, arg_, counts);
+        }
+    }
+
+    auto operator=(HardwareCounterScope const&) -> HardwareCounterScope& = delete;
+
+    auto operator=(HardwareCounterScope&&) -> HardwareCounterScope& = delete;
+
+private:
+    char const* name_;
+    uint64_t arg_;
+    HardwareCounts begin_;
+};
+}
+
+// compiled in with CYCLONITE_ENABLE_HARDWARE_COUNTERS (see ENABLE_HARDWARE_COUNTERS cmake option),
+// off until HardwareCounters::start
+#if defined(CYCLONITE_ENABLE_HARDWARE_COUNTERS)
+#define CYCLONITE_COUNTERS(name)                                                                                       \
+    ::cyclonite::profiling::HardwareCounterScope CYCLONITE_COUNTERS_CONCAT(cycloniteCounters, __LINE__){ name }
+#define CYCLONITE_COUNTERS_ARG(name, arg)                                                                              \
+    ::cyclonite::profiling::HardwareCounterScope CYCLONITE_COUNTERS_CONCAT(cycloniteCounters, __LINE__){               \
+        name, static_cast<uint64_t>(arg)                                                                               \
+    }
+#else
+#define CYCLONITE_COUNTERS(name) (void)0
+#define CYCLONITE_COUNTERS_ARG(name, arg) (void)0
+#endif
+
+#define CYCLONITE_COUNTERS_CONCAT_IMPL(a, b) a##b
+#define CYCLONITE_COUNTERS_CONCAT(a, b) CYCLONITE_COUNTERS_CONCAT_IMPL(a, b)
+
+#endif // CYCLONITE_HARDWARECOUNTERS_H
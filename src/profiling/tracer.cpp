@@ -0,0 +1,253 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "tracer.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cyclonite::profiling {
+std::atomic<bool> Tracer::enabled_{ false };
+
+namespace {
+struct event_t
+{
+    std::atomic<char const*> name;
+    std::atomic<uint64_t> timestamp;
+    std::atomic<uint64_t> arg;
+    std::atomic<TraceEventType> type;
+};
+
+// single writer ring, claimed goes ahead of the write and head follows it,
+// so a reader knows which of the copied events could be overwritten meanwhile
+struct thread_trace_t
+{
+    thread_trace_t(uint32_t index, std::string name)
+      : events{ std::make_unique<event_t[]>(Tracer::ring_size_v) }
+      , claimed{ 0 }
+      , head{ 0 }
+      , tail{ 0 }
+      , index{ index }
+      , name{ std::move(name) }
+    {
+    }
+
+    std::unique_ptr<event_t[]> events;
+    std::atomic<uint64_t> claimed;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail; // the events before are cleared
+    uint32_t index;
+    std::string name; // guarded by the registry mutex
+};
+
+// traces outlive their threads, the events of finished threads are still written out
+struct registry_t
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<thread_trace_t>> threads;
+};
+
+struct event_copy_t
+{
+    char const* name;
+    uint64_t timestamp;
+    uint64_t arg;
+    TraceEventType type;
+};
+}
+
+static auto _registry() -> registry_t&
+{
+    static auto registry = registry_t{};
+    return registry;
+}
+
+static auto const _epoch = std::chrono::steady_clock::now();
+
+static thread_local thread_trace_t* _threadTrace = nullptr;
+static thread_local std::string _threadName = {};
+
+static auto _register() -> thread_trace_t*
+{
+    auto& registry = _registry();
+    auto lock = std::lock_guard{ registry.mutex };
+
+    _threadTrace = registry.threads
+                     .emplace_back(std::make_unique<thread_trace_t>(static_cast<uint32_t>(registry.threads.size()),
+                                                                    std::move(_threadName)))
+                     .get();
+
+    return _threadTrace;
+}
+
+void Tracer::start()
+{
+    clear();
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop()
+{
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::setThreadName(std::string_view name)
+{
+    // the buffer is allocated on the first event, until then the name waits here
+    if (_threadTrace == nullptr) {
+        _threadName = name;
+        return;
+    }
+
+    auto lock = std::lock_guard{ _registry().mutex };
+    _threadTrace->name = name;
+}
+
+void Tracer::record(TraceEventType type, char const* name, uint64_t arg)
+{
+    auto* trace = _threadTrace != nullptr ? _threadTrace : _register();
+
+    auto const index = trace->head.load(std::memory_order_relaxed);
+    auto& event = trace->events[index & (ring_size_v - 1)];
+
+    auto const timestamp = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count());
+
+    trace->claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.name.store(name, std::memory_order_relaxed);
+    event.timestamp.store(timestamp, std::memory_order_relaxed);
+    event.arg.store(arg, std::memory_order_relaxed);
+    event.type.store(type, std::memory_order_relaxed);
+
+    trace->head.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::clear()
+{
+    auto& registry = _registry();
+    auto lock = std::lock_guard{ registry.mutex };
+
+    for (auto&& trace : registry.threads)
+        trace->tail.store(trace->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+static void _writeString(std::ostream& stream, std::string_view string)
+{
+    stream << '"';
+
+    for (auto c : string) {
+        if (c == '"' || c == '\\') {
+            stream << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            stream << ' ';
+        } else {
+            stream << c;
+        }
+    }
+
+    stream << '"';
+}
+
+// microseconds with the nanosecond fraction
+static void _writeTimestamp(std::ostream& stream, uint64_t nanoseconds)
+{
+    auto fraction = std::to_string(nanoseconds % 1000);
+
+    stream << nanoseconds / 1000 << '.' << std::string(3 - fraction.size(), '0') << fraction;
+}
+
+static void _writeThread(std::ostream& stream, thread_trace_t const& trace, bool& first)
+{
+    constexpr auto ring_size = Tracer::ring_size_v;
+
+    auto separator = [&stream, &first]() -> std::ostream& {
+        if (!first)
+            stream << ',';
+
+        first = false;
+        return stream << '\n';
+    };
+
+    auto head = trace.head.load(std::memory_order_acquire);
+    auto begin = std::max(trace.tail.load(std::memory_order_relaxed), head > ring_size ? head - ring_size : 0);
+
+    auto events = std::vector<event_copy_t>{};
+    events.reserve(head - begin);
+
+    for (auto i = begin; i < head; i++) {
+        auto const& event = trace.events[i & (ring_size - 1)];
+
+        events.push_back(event_copy_t{ event.name.load(std::memory_order_relaxed),
+                                       event.timestamp.load(std::memory_order_relaxed),
+                                       event.arg.load(std::memory_order_relaxed),
+                                       event.type.load(std::memory_order_relaxed) });
+    }
+
+    // the writer went on while copying, its slots are not trusted
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    auto claimed = trace.claimed.load(std::memory_order_relaxed);
+    auto valid = std::max(begin, claimed > ring_size ? claimed - ring_size : 0);
+
+    separator() << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << trace.index << R"(,"args":{"name":)";
+    _writeString(stream, trace.name.empty() ? "thread " + std::to_string(trace.index) : trace.name);
+    stream << "}}";
+
+    // the beginnings of the oldest zones could be overwritten
+    auto depth = size_t{ 0 };
+
+    for (auto i = std::min(valid, head); i < head; i++) {
+        auto const& event = events[i - begin];
+
+        if (event.type == TraceEventType::ZONE_END && depth == 0)
+            continue;
+
+        separator() << R"({"name":)";
+        _writeString(stream, event.name);
+        stream << R"(,"ts":)";
+        _writeTimestamp(stream, event.timestamp);
+        stream << R"(,"pid":0,"tid":)" << trace.index;
+
+        switch (event.type) {
+            case TraceEventType::ZONE_BEGIN:
+                depth++;
+                stream << R"(,"cat":"zone","ph":"B","args":{"arg":)" << event.arg << "}}";
+                break;
+            case TraceEventType::ZONE_END:
+                depth--;
+                stream << R"(,"cat":"zone","ph":"E"})";
+                break;
+            case TraceEventType::FLOW_BEGIN:
+                stream << R"(,"cat":"flow","ph":"s","id":)" << event.arg << "}";
+                break;
+            case TraceEventType::FLOW_END:
+                stream << R"(,"cat":"flow","ph":"f","bp":"e","id":)" << event.arg << "}";
+                break;
+            default:
+                assert(false);
+        }
+    }
+}
+
+void Tracer::writeChromeTrace(std::ostream& stream)
+{
+    auto& registry = _registry();
+    auto lock = std::lock_guard{ registry.mutex };
+
+    auto first = true;
+
+    stream << R"({"displayTimeUnit":"ns","traceEvents":[)";
+
+    for (auto&& trace : registry.threads)
+        _writeThread(stream, *trace, first);
+
+    stream << "\n]}\n";
+}
+}
@@ -0,0 +1,114 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_TRACER_H
+#define CYCLONITE_TRACER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace cyclonite::profiling {
+enum class TraceEventType : uint8_t
+{
+    ZONE_BEGIN = 0,
+    ZONE_END = 1,
+    FLOW_BEGIN = 2, // a task is submitted
+    FLOW_END = 3,   // the task starts, the viewer draws an arrow between the threads
+    MIN_VALUE = ZONE_BEGIN,
+    MAX_VALUE = FLOW_END,
+    COUNT = MAX_VALUE + 1
+};
+
+// timeline of zones and task flows, every thread writes into its own ring buffer without locks,
+// the oldest events are overwritten, names are expected to be string literals (only the pointer is kept)
+// nothing is recorded (and no buffer is allocated) until start
+class Tracer
+{
+public:
+    // events per thread
+    static constexpr size_t ring_size_v = size_t{ 1 } << 16;
+
+    static void start();
+
+    static void stop();
+
+    [[nodiscard]] static auto enabled() -> bool { return enabled_.load(std::memory_order_relaxed); }
+
+    // the name shows up in the viewer instead of the thread index
+    static void setThreadName(std::string_view name);
+
+    static void record(TraceEventType type, char const* name, uint64_t arg);
+
+    // drops all of the recorded events
+    static void clear();
+
+    // chrome trace event json, chrome://tracing and perfetto ui open it,
+    // threads may keep recording meanwhile, the events overwritten while reading are skipped
+    static void writeChromeTrace(std::ostream& stream);
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+// a scope on the timeline of the thread, costs a relaxed load while the tracer is off
+class Zone
+{
+public:
+    explicit Zone(char const* name, uint64_t arg = 0) noexcept
+      : name_{ Tracer::enabled() ? name : nullptr }
+    {
+        if (name_ != nullptr)
+            Tracer::record(TraceEventType::ZONE_BEGIN, name_, arg);
+    }
+
+    Zone(Zone const&) = delete;
+
+    Zone(Zone&&) = delete;
+
+    ~Zone()
+    {
+        if (name_ != nullptr)
+            Tracer::record(TraceEventType::ZONE_END, name_, 0);
+    }
+
+    auto operator=(Zone const&) -> Zone& = delete;
+
+    auto operator=(Zone&&) -> Zone& = delete;
+
+private:
+    char const* name_;
+};
+
+inline void traceFlow(TraceEventType type, uint64_t id)
+{
+    if (Tracer::enabled())
+        Tracer::record(type, "task", id);
+}
+}
+
+#define CYCLONITE_TRACE_CONCAT_IMPL(a, b) a##b
+#define CYCLONITE_TRACE_CONCAT(a, b) CYCLONITE_TRACE_CONCAT_IMPL(a, b)
+
+// tracing is compiled in with CYCLONITE_ENABLE_TRACING (see ENABLE_TRACING cmake option), it is off until Tracer::start
+#if defined(CYCLONITE_ENABLE_TRACING)
+#define CYCLONITE_ZONE(name) ::cyclonite::profiling::Zone CYCLONITE_TRACE_CONCAT(cycloniteZone, __LINE__){ name }
+#define CYCLONITE_ZONE_ARG(name, arg)                                                                                  \
+    ::cyclonite::profiling::Zone CYCLONITE_TRACE_CONCAT(cycloniteZone, __LINE__){ name, static_cast<uint64_t>(arg) }
+#define CYCLONITE_TRACE_FLOW_BEGIN(id)                                                                                 \
+    ::cyclonite::profiling::traceFlow(::cyclonite::profiling::TraceEventType::FLOW_BEGIN, id)
+#define CYCLONITE_TRACE_FLOW_END(id)                                                                                   \
+    ::cyclonite::profiling::traceFlow(::cyclonite::profiling::TraceEventType::FLOW_END, id)
+#define CYCLONITE_TRACE_THREAD_NAME(name) ::cyclonite::profiling::Tracer::setThreadName(name)
+#else
+#define CYCLONITE_ZONE(name) (void)0
+#define CYCLONITE_ZONE_ARG(name, arg) (void)0
+#define CYCLONITE_TRACE_FLOW_BEGIN(id) (void)0
+#define CYCLONITE_TRACE_FLOW_END(id) (void)0
+#define CYCLONITE_TRACE_THREAD_NAME(name) (void)0
+#endif
+
+#endif // CYCLONITE_TRACER_H
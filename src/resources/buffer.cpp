@@ -9,11 +9,38 @@ Resource::ResourceTag Buffer::tag{};
 
 Buffer::Buffer(size_t size) noexcept
   : Resource(size)
+  , mapping_{}
 {
 }
 
+Buffer::Buffer(std::filesystem::path const& path, size_t size)
+  : Resource{}
+  , mapping_{ std::in_place, path, size }
+{
+    state_ = ResourceState::COMPLETE;
+}
+
+Buffer::Buffer(std::filesystem::path const& path)
+  : Buffer{ path, static_cast<size_t>(std::filesystem::file_size(path)) }
+{
+}
+
+auto Buffer::data() const -> std::byte const*
+{
+    return mapping_ ? mapping_->data() : dynamicData();
+}
+
+auto Buffer::data() -> std::byte*
+{
+    // the pages of the mapping are read-only
+    assert(!mapped());
+    return dynamicData();
+}
+
 void Buffer::load(std::istream& stream)
 {
+    assert(!mapped());
+
     state_ = ResourceState::LOADING;
     stream.read(reinterpret_cast<char*>(dynamicData()), static_cast<std::streamsize>(dynamicDataSize()));
 
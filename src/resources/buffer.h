@@ -6,26 +6,47 @@
 #define CYCLONITE_RESOURCE_BUFFER_H
 
 #include "buffers/bufferView.h"
+#include "internal/fileMapping.h"
 #include "resource.h"
 #include <array>
+#include <optional>
 
 namespace cyclonite::resources {
+// keeps the data in the dynamic buffer of the manager or maps it straight from the file,
+// the mapped one is complete once it is created and is read-only
 class Buffer : public Resource
 {
 public:
     explicit Buffer(size_t size) noexcept;
 
+    // maps the first (size) bytes of the file
+    Buffer(std::filesystem::path const& path, size_t size);
+
+    explicit Buffer(std::filesystem::path const& path);
+
     [[nodiscard]] auto instance_tag() const -> ResourceTag const& override { return tag; }
 
-    [[nodiscard]] auto size() const -> size_t { return dynamicDataSize(); }
+    [[nodiscard]] auto size() const -> size_t { return mapping_ ? mapping_->size() : dynamicDataSize(); }
+
+    [[nodiscard]] auto mapped() const -> bool { return mapping_.has_value(); }
 
-    auto data() -> std::byte* { return dynamicData(); }
+    [[nodiscard]] auto data() const -> std::byte const*;
+
+    // the mapped data is read-only, it is reached through the const overloads only
+    auto data() -> std::byte*;
+
+    template<typename DataType>
+    [[nodiscard]] auto view(size_t offset, size_t count, size_t stride = sizeof(DataType)) const
+      -> buffers::BufferView<DataType const>;
 
     template<typename DataType>
     auto view(size_t offset, size_t count, size_t stride = sizeof(DataType)) -> buffers::BufferView<DataType>;
 
     void load(std::istream& stream) override;
 
+private:
+    std::optional<internal::FileMapping> mapping_;
+
 private:
     static ResourceTag tag;
 
@@ -34,6 +55,13 @@ public:
     static auto type_tag() -> ResourceTag& { return Buffer::tag; }
 };
 
+template<typename DataType>
+auto Buffer::view(size_t offset, size_t count, size_t stride /* = sizeof(DataType)*/) const
+  -> buffers::BufferView<DataType const>
+{
+    return buffers::BufferView<DataType const>{ data(), offset, count, stride };
+}
+
 template<typename DataType>
 auto Buffer::view(size_t offset, size_t count, size_t stride /* = sizeof(DataType)*/) -> buffers::BufferView<DataType>
 {
@@ -6,11 +6,15 @@
 #define CYCLONITE_CONTIGUOUSDATA_H
 
 #include "resource.h"
+#include <type_traits>
 
 namespace cyclonite::resources {
+// the compaction moves the data as bytes and never constructs it again, see ResourceManager::compact
 template<typename DataType>
 class ContiguousData : public resources::Resource
 {
+    static_assert(std::is_trivially_copyable_v<DataType>, "the data is relocated with memmove");
+
 public:
     class Iterator
     {
@@ -84,6 +88,8 @@ private:
 protected:
     void handleDynamicDataAllocation() override;
 
+    void handleDynamicDataRelocation() override;
+
 public:
     static auto type_tag_const() -> ResourceTag const& { return ContiguousData::tag; }
     static auto type_tag() -> ResourceTag& { return ContiguousData::tag; }
@@ -98,7 +104,7 @@ Resource::ResourceTag ContiguousData<DataType>::tag{};
 
 template<typename DataType>
 ContiguousData<DataType>::ContiguousData(size_t dataCount) noexcept
-  : resources::Resource{ dataCount * sizeof(DataType) }
+  : resources::Resource{ dataCount * sizeof(DataType), alignof(DataType) }
   , data_{ nullptr }
   , count_{ dataCount }
 {
@@ -110,6 +116,13 @@ void ContiguousData<DataType>::handleDynamicDataAllocation()
     data_ = new (dynamicData()) DataType[count_];
 }
 
+template<typename DataType>
+void ContiguousData<DataType>::handleDynamicDataRelocation()
+{
+    // the objects were moved as bytes, that is fine for trivially copyable ones
+    data_ = reinterpret_cast<DataType*>(dynamicData());
+}
+
 template<typename DataType>
 ContiguousData<DataType>::Iterator::Iterator(DataType* data, size_t count, difference_type index) noexcept
   : data_{ data }
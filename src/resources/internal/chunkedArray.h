@@ -0,0 +1,98 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_CHUNKEDARRAY_H
+#define CYCLONITE_CHUNKEDARRAY_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace cyclonite::resources::internal {
+// grows by chunks and never relocates elements, so references to them stay valid
+// chunk k keeps (baseSize << k) elements, base size is a power of two, so an access is a couple of shifts
+// an element is (stride) consecutive values of T, access doesn't lock, growth has to be serialized by the owner
+template<typename T>
+class ChunkedArray
+{
+    static constexpr size_t max_chunk_count_v = 24;
+
+public:
+    explicit ChunkedArray(size_t baseSize, size_t stride = 1);
+
+    ChunkedArray(ChunkedArray const&) = delete;
+
+    ChunkedArray(ChunkedArray&&) = delete;
+
+    ~ChunkedArray() = default;
+
+    auto operator=(ChunkedArray const&) -> ChunkedArray& = delete;
+
+    auto operator=(ChunkedArray&&) -> ChunkedArray& = delete;
+
+    [[nodiscard]] auto capacity() const -> size_t { return capacity_.load(std::memory_order_acquire); }
+
+    [[nodiscard]] auto operator[](size_t index) const -> T const&;
+
+    auto operator[](size_t index) -> T&;
+
+    // adds a chunk of the same size as all of the previous ones together
+    void grow();
+
+private:
+    size_t baseShift_;
+    size_t stride_;
+    std::array<std::unique_ptr<T[]>, max_chunk_count_v> chunks_;
+    size_t chunkCount_;
+    std::atomic<size_t> capacity_;
+};
+
+template<typename T>
+ChunkedArray<T>::ChunkedArray(size_t baseSize, size_t stride)
+  : baseShift_{ static_cast<size_t>(std::countr_zero(std::bit_ceil(baseSize))) }
+  , stride_{ stride }
+  , chunks_{}
+  , chunkCount_{ 0 }
+  , capacity_{ 0 }
+{
+    assert(baseSize > 0);
+    assert(stride_ > 0);
+    grow();
+}
+
+template<typename T>
+auto ChunkedArray<T>::operator[](size_t index) const -> T const&
+{
+    assert(index < capacity());
+
+    auto chunkIndex = static_cast<size_t>(std::bit_width((index >> baseShift_) + 1) - 1);
+    auto offset = index + (size_t{ 1 } << baseShift_) - (size_t{ 1 } << (baseShift_ + chunkIndex));
+
+    return chunks_[chunkIndex][offset * stride_];
+}
+
+template<typename T>
+auto ChunkedArray<T>::operator[](size_t index) -> T&
+{
+    return const_cast<T&>(std::as_const(*this)[index]);
+}
+
+template<typename T>
+void ChunkedArray<T>::grow()
+{
+    assert(chunkCount_ < max_chunk_count_v);
+
+    auto chunkSize = size_t{ 1 } << (baseShift_ + chunkCount_);
+
+    chunks_[chunkCount_++] = std::make_unique<T[]>(chunkSize * stride_);
+
+    capacity_.fetch_add(chunkSize, std::memory_order_release);
+}
+}
+
+#endif // CYCLONITE_CHUNKEDARRAY_H
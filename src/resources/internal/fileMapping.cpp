@@ -0,0 +1,123 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "fileMapping.h"
+#include <system_error>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cyclonite::resources::internal {
+#if defined(_WIN32)
+static auto _lastError() -> std::error_code
+{
+    return std::error_code{ static_cast<int>(GetLastError()), std::system_category() };
+}
+#else
+static auto _lastError() -> std::error_code
+{
+    return std::error_code{ errno, std::generic_category() };
+}
+#endif
+
+FileMapping::FileMapping(std::filesystem::path const& path, size_t size)
+  : data_{ nullptr }
+  , size_{ size }
+{
+#if defined(_WIN32)
+    // the sequential scan flag is the read-ahead hint of the cache manager
+    auto file = CreateFileW(path.c_str(),
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::system_error{ _lastError(), path.string() };
+
+    auto fileSize = LARGE_INTEGER{};
+
+    if (!GetFileSizeEx(file, &fileSize) || static_cast<size_t>(fileSize.QuadPart) < size_) {
+        CloseHandle(file);
+        throw std::system_error{ std::make_error_code(std::errc::invalid_argument), path.string() };
+    }
+
+    if (size_ == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    auto error = _lastError();
+
+    CloseHandle(file);
+
+    if (mapping == nullptr)
+        throw std::system_error{ error, path.string() };
+
+    // the view keeps the mapping object alive
+    data_ = static_cast<std::byte const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size_));
+    error = _lastError();
+
+    CloseHandle(mapping);
+
+    if (data_ == nullptr)
+        throw std::system_error{ error, path.string() };
+#else
+    auto file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (file < 0)
+        throw std::system_error{ _lastError(), path.string() };
+
+    struct stat fileStat = {};
+
+    if (fstat(file, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < size_) {
+        close(file);
+        throw std::system_error{ std::make_error_code(std::errc::invalid_argument), path.string() };
+    }
+
+    if (size_ == 0) {
+        close(file);
+        return;
+    }
+
+    auto* ptr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0);
+    auto error = _lastError();
+
+    // the mapping keeps the file
+    close(file);
+
+    if (ptr == MAP_FAILED)
+        throw std::system_error{ error, path.string() };
+
+    data_ = static_cast<std::byte const*>(ptr);
+
+    // the data is usually read front to back once, so it is read ahead aggressively and dropped behind,
+    // and the reading starts right now, the hints are not critical, so their failures are ignored
+    madvise(ptr, size_, MADV_SEQUENTIAL);
+    madvise(ptr, size_, MADV_WILLNEED);
+#endif
+}
+
+FileMapping::~FileMapping()
+{
+    if (data_ == nullptr)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<std::byte*>(data_), size_);
+#endif
+}
+}
@@ -0,0 +1,40 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_FILEMAPPING_H
+#define CYCLONITE_FILEMAPPING_H
+
+#include <cstddef>
+#include <filesystem>
+
+namespace cyclonite::resources::internal {
+// maps the beginning of the file read-only, the pages are read on the first access
+// and are shared with the other processes which map the same file, nothing is copied
+class FileMapping
+{
+public:
+    // throws std::system_error if the file can not be mapped or is smaller than the size
+    FileMapping(std::filesystem::path const& path, size_t size);
+
+    FileMapping(FileMapping const&) = delete;
+
+    FileMapping(FileMapping&&) = delete;
+
+    ~FileMapping();
+
+    auto operator=(FileMapping const&) -> FileMapping& = delete;
+
+    auto operator=(FileMapping&&) -> FileMapping& = delete;
+
+    [[nodiscard]] auto data() const -> std::byte const* { return data_; }
+
+    [[nodiscard]] auto size() const -> size_t { return size_; }
+
+private:
+    std::byte const* data_;
+    size_t size_;
+};
+}
+
+#endif // CYCLONITE_FILEMAPPING_H
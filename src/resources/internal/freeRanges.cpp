@@ -0,0 +1,144 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "freeRanges.h"
+#include <bit>
+#include <cassert>
+#include <iterator>
+
+namespace cyclonite::resources::internal {
+FreeRanges::FreeRanges() noexcept
+  : byOffset_{}
+  , bySize_{}
+  , freeSize_{ 0 }
+{
+}
+
+auto FreeRanges::alloc(size_t size, size_t alignment) -> std::optional<size_t>
+{
+    assert(size > 0);
+    assert(std::has_single_bit(alignment));
+
+    // a range of (size + alignment - 1) fits wherever it is, a smaller one fits only at a suitable offset,
+    // a few of the smaller ones are tried first to keep the fit tight
+    constexpr auto probeCount = 8;
+
+    auto it = bySize_.lower_bound(std::pair{ size, size_t{ 0 } });
+
+    for (auto probe = 0; it != bySize_.end() && it->first < size + alignment - 1; ++it) {
+        auto [rangeSize, rangeOffset] = *it;
+        auto alignedOffset = (rangeOffset + alignment - 1) & ~(alignment - 1);
+
+        if (rangeSize >= size + (alignedOffset - rangeOffset))
+            break;
+
+        if (++probe == probeCount) {
+            it = bySize_.lower_bound(std::pair{ size + alignment - 1, size_t{ 0 } });
+            break;
+        }
+    }
+
+    if (it == bySize_.end())
+        return std::nullopt;
+
+    auto [rangeSize, rangeOffset] = *it;
+    auto alignedOffset = (rangeOffset + alignment - 1) & ~(alignment - 1);
+    auto padding = alignedOffset - rangeOffset;
+
+    assert(rangeSize >= size + padding);
+
+    erase(byOffset_.find(rangeOffset));
+
+    if (padding > 0)
+        insert(rangeOffset, padding);
+
+    if (auto rest = rangeSize - padding - size; rest > 0)
+        insert(alignedOffset + size, rest);
+
+    return alignedOffset;
+}
+
+void FreeRanges::free(size_t offset, size_t size)
+{
+    assert(size > 0);
+
+    auto next = byOffset_.lower_bound(offset);
+
+    assert(next == byOffset_.end() || next->first >= offset + size);
+
+    if (next != byOffset_.begin()) {
+        auto prev = std::prev(next);
+
+        assert(prev->first + prev->second <= offset);
+
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+
+            erase(prev);
+        }
+    }
+
+    if (next != byOffset_.end() && next->first == offset + size) {
+        size += next->second;
+
+        erase(next);
+    }
+
+    insert(offset, size);
+}
+
+void FreeRanges::take(size_t offset, size_t size)
+{
+    assert(size > 0);
+
+    auto it = byOffset_.upper_bound(offset);
+
+    assert(it != byOffset_.begin());
+
+    it = std::prev(it);
+
+    auto [rangeOffset, rangeSize] = *it;
+
+    assert(rangeOffset + rangeSize >= offset + size);
+
+    erase(it);
+
+    if (offset > rangeOffset)
+        insert(rangeOffset, offset - rangeOffset);
+
+    if (auto rest = rangeOffset + rangeSize - offset - size; rest > 0)
+        insert(offset + size, rest);
+}
+
+auto FreeRanges::next(size_t offset) const -> std::optional<std::pair<size_t, size_t>>
+{
+    auto it = byOffset_.lower_bound(offset);
+
+    if (it == byOffset_.end())
+        return std::nullopt;
+
+    return *it;
+}
+
+void FreeRanges::insert(size_t offset, size_t size)
+{
+    byOffset_.emplace(offset, size);
+    bySize_.emplace(size, offset);
+
+    freeSize_ += size;
+}
+
+void FreeRanges::erase(std::map<size_t, size_t>::iterator it)
+{
+    assert(it != byOffset_.end());
+
+    auto [offset, size] = *it;
+
+    bySize_.erase(std::pair{ size, offset });
+    byOffset_.erase(it);
+
+    freeSize_ -= size;
+}
+}
@@ -0,0 +1,52 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_FREERANGES_H
+#define CYCLONITE_FREERANGES_H
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+
+namespace cyclonite::resources::internal {
+// free ranges of a dynamic buffer, every range is in two trees:
+// by offset to find the neighbours to merge with and by size to find the best fit, both in O(log n)
+class FreeRanges
+{
+public:
+    FreeRanges() noexcept;
+
+    // the best fit range which can keep the size at the aligned offset, the alignment is a power of two
+    [[nodiscard]] auto alloc(size_t size, size_t alignment) -> std::optional<size_t>;
+
+    // merges the range with the free neighbours
+    void free(size_t offset, size_t size);
+
+    // cuts the range out of a free one which contains it, the leftovers on both sides stay free
+    void take(size_t offset, size_t size);
+
+    // the first free range at or after the offset as (offset, size)
+    [[nodiscard]] auto next(size_t offset) const -> std::optional<std::pair<size_t, size_t>>;
+
+    [[nodiscard]] auto count() const -> size_t { return byOffset_.size(); }
+
+    [[nodiscard]] auto freeSize() const -> size_t { return freeSize_; }
+
+    [[nodiscard]] auto maxRangeSize() const -> size_t { return bySize_.empty() ? 0 : bySize_.rbegin()->first; }
+
+private:
+    void insert(size_t offset, size_t size);
+
+    void erase(std::map<size_t, size_t>::iterator it);
+
+private:
+    std::map<size_t, size_t> byOffset_;          // offset -> size
+    std::set<std::pair<size_t, size_t>> bySize_; // (size, offset)
+    size_t freeSize_;
+};
+}
+
+#endif // CYCLONITE_FREERANGES_H
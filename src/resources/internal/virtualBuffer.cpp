@@ -0,0 +1,96 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#include "virtualBuffer.h"
+#include <cassert>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace cyclonite::resources::internal {
+static auto _roundUp(size_t size, size_t alignment) -> size_t
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+VirtualBuffer::VirtualBuffer(size_t reservedSize, size_t initialSize)
+  : data_{ nullptr }
+  , size_{ 0 }
+  , reservedSize_{ _roundUp(reservedSize, pageSize()) }
+{
+    assert(initialSize <= reservedSize_);
+
+#if defined(_WIN32)
+    data_ = static_cast<std::byte*>(VirtualAlloc(nullptr, reservedSize_, MEM_RESERVE, PAGE_NOACCESS));
+
+    if (data_ == nullptr)
+        throw std::bad_alloc{};
+#else
+    auto* ptr = mmap(nullptr, reservedSize_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (ptr == MAP_FAILED)
+        throw std::bad_alloc{};
+
+    data_ = static_cast<std::byte*>(ptr);
+#endif
+
+    resize(initialSize);
+}
+
+VirtualBuffer::~VirtualBuffer()
+{
+    if (data_ == nullptr)
+        return;
+
+#if defined(_WIN32)
+    VirtualFree(data_, 0, MEM_RELEASE);
+#else
+    munmap(data_, reservedSize_);
+#endif
+}
+
+void VirtualBuffer::resize(size_t size)
+{
+    auto newSize = _roundUp(size, pageSize());
+
+    if (newSize <= size_)
+        return;
+
+    if (newSize > reservedSize_)
+        throw std::bad_alloc{};
+
+    // new pages come zeroed
+#if defined(_WIN32)
+    if (VirtualAlloc(data_ + size_, newSize - size_, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+        throw std::bad_alloc{};
+#else
+    if (mprotect(data_ + size_, newSize - size_, PROT_READ | PROT_WRITE) != 0)
+        throw std::bad_alloc{};
+#endif
+
+    size_ = newSize;
+}
+
+auto VirtualBuffer::pageSize() -> size_t
+{
+    static auto const pageSize = []() -> size_t {
+#if defined(_WIN32)
+        auto systemInfo = SYSTEM_INFO{};
+        GetSystemInfo(&systemInfo);
+
+        // the reservation granularity, commits are by pages inside of it
+        return static_cast<size_t>(systemInfo.dwAllocationGranularity);
+#else
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }();
+
+    return pageSize;
+}
+}
@@ -0,0 +1,46 @@
+//
+// Created by bantdit on 10/17/26.
+//
+
+#ifndef CYCLONITE_VIRTUALBUFFER_H
+#define CYCLONITE_VIRTUALBUFFER_H
+
+#include <cstddef>
+
+namespace cyclonite::resources::internal {
+// reserves the address space once and commits it by pages when it grows,
+// so the data never moves and growth costs no copy, uncommitted pages take no memory
+class VirtualBuffer
+{
+public:
+    VirtualBuffer(size_t reservedSize, size_t initialSize);
+
+    VirtualBuffer(VirtualBuffer const&) = delete;
+
+    VirtualBuffer(VirtualBuffer&&) = delete;
+
+    ~VirtualBuffer();
+
+    auto operator=(VirtualBuffer const&) -> VirtualBuffer& = delete;
+
+    auto operator=(VirtualBuffer&&) -> VirtualBuffer& = delete;
+
+    [[nodiscard]] auto data() const -> std::byte* { return data_; }
+
+    [[nodiscard]] auto size() const -> size_t { return size_; }
+
+    [[nodiscard]] auto reservedSize() const -> size_t { return reservedSize_; }
+
+    // commits the pages up to the size rounded to the page size, throws std::bad_alloc beyond the reservation
+    void resize(size_t size);
+
+    static auto pageSize() -> size_t;
+
+private:
+    std::byte* data_;
+    size_t size_;
+    size_t reservedSize_;
+};
+}
+
+#endif // CYCLONITE_VIRTUALBUFFER_H
@@ -4,6 +4,7 @@
 
 #include "resource.h"
 #include "resourceManager.h"
+#include <bit>
 #include <boost/iostreams/device/array.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <fstream>
@@ -39,17 +40,25 @@ Resource::Resource() noexcept
   , resourceManager_{ nullptr }
   , dynamicOffset_{ std::numeric_limits<size_t>::max() }
   , dynamicSize_{ 0 }
+  , dynamicAlignment_{ 1 }
   , state_{ ResourceState::UNLOADED }
 {
 }
 
 Resource::Resource(size_t dynamicSize) noexcept
+  : Resource{ dynamicSize, alignof(std::max_align_t) }
+{
+}
+
+Resource::Resource(size_t dynamicSize, size_t dynamicAlignment) noexcept
   : id_{}
   , resourceManager_{ nullptr }
   , dynamicOffset_{ std::numeric_limits<size_t>::max() }
   , dynamicSize_{ dynamicSize }
+  , dynamicAlignment_{ dynamicAlignment }
   , state_{ ResourceState::UNLOADED }
 {
+    assert(std::has_single_bit(dynamicAlignment_));
 }
 
 auto Resource::dynamicData() -> std::byte*
@@ -90,6 +99,8 @@ void Resource::handleDynamicDataAllocation() {}
 
 void Resource::handlePostAllocation() {}
 
+void Resource::handleDynamicDataRelocation() {}
+
 auto Resource::resourceManager() const -> ResourceManager&
 {
     assert(resourceManager_ != nullptr);
@@ -33,12 +33,16 @@ protected:
 
     explicit Resource(size_t dynamicSize) noexcept;
 
+    Resource(size_t dynamicSize, size_t dynamicAlignment) noexcept;
+
     [[nodiscard]] auto resourceManager() const -> ResourceManager&;
 
     [[nodiscard]] auto dynamicDataSize() const -> size_t { return dynamicSize_; }
 
     [[nodiscard]] auto dynamicDataOffset() const -> size_t { return dynamicOffset_; }
 
+    [[nodiscard]] auto dynamicDataAlignment() const -> size_t { return dynamicAlignment_; }
+
     [[nodiscard]] auto dynamicData() const -> std::byte const*;
 
     auto dynamicData() -> std::byte*;
@@ -105,6 +109,9 @@ protected:
 
     virtual void handlePostAllocation();
 
+    // the dynamic data was moved by the compaction, pointers into it have to be taken again
+    virtual void handleDynamicDataRelocation();
+
 protected:
     struct ResourceTag
     {
@@ -131,6 +138,7 @@ private:
     ResourceManager* resourceManager_;
     size_t dynamicOffset_;
     size_t dynamicSize_;
+    size_t dynamicAlignment_;
 
 protected:
     std::atomic<ResourceState> state_;
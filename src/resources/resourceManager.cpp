@@ -3,131 +3,131 @@
 //
 
 #include "resourceManager.h"
+#include "multithreading/taskManager.h"
+#include <cstring>
+#include <stdexcept>
 
 namespace cyclonite::resources {
-ResourceManager::ResourceManager() noexcept
-  : resources_{}
+ResourceManager::ResourceManager()
+  : resources_{ 1024 }
+  , resourceCount_{ 0 }
   , freeResourceIndices_{}
+  , resourceMutex_{}
   , storages_{}
-  , freeItems_{}
   , buffers_{}
-  , freeRanges_{}
+  , relocationCount_{ 0 }
+  , loads_{}
+  , loadMutex_{}
 {
 }
 
 auto ResourceManager::allocResource(Resource::ResourceTag tag, size_t size) -> Resource::Id
 {
-    auto version = uint32_t{ 1 };
     auto index = std::numeric_limits<uint32_t>::max();
+    auto reused = false;
 
-    if (!freeResourceIndices_.empty()) {
-        index = freeResourceIndices_.back();
-        freeResourceIndices_.pop_back();
+    {
+        std::lock_guard<std::mutex> lock{ resourceMutex_ };
 
-        version = resources_[index].version;
-    } else {
-        index = resources_.size();
-        resources_.emplace_back();
-    }
+        if (!freeResourceIndices_.empty()) {
+            index = freeResourceIndices_.back();
+            freeResourceIndices_.pop_back();
 
-    assert(index < resources_.size());
+            reused = true;
+        } else {
+            index = resourceCount_.load(std::memory_order_relaxed);
 
-    auto& storage = storages_[tag.staticDataIndex];
-    auto& items = freeItems_[tag.staticDataIndex];
+            if (index == resources_.capacity()) {
+                resources_.grow();
+            }
+
+            resourceCount_.store(index + 1, std::memory_order_release);
+        }
+    }
 
+    // nobody else knows the index until the id is returned, only the version may be read concurrently
+    auto& resource = resources_[index];
+    auto& storage = storages_[tag.staticDataIndex];
     auto itemIndex = uint32_t{ 0 };
 
-    if (items.size() > 1) {
-        itemIndex = items.back();
-        items.pop_back();
-    } else {
-        itemIndex = items.back()++;
-    }
+    assert(storage.item_size == size);
+
+    {
+        std::lock_guard<std::mutex> lock{ storage.mutex };
+
+        auto& items = storage.freeItems;
 
-    if ((itemIndex * size) >= storage.size()) {
-        storage.resize(storage.size() * 2, std::byte{ 0 });
+        if (items.size() > 1) {
+            itemIndex = items.back();
+            items.pop_back();
+        } else {
+            itemIndex = items.back()++;
+        }
+
+        if (itemIndex == storage.items.capacity()) {
+            storage.items.grow();
+        }
+
+        resource.dense_index = static_cast<uint32_t>(storage.dense.size());
+        storage.dense.push_back(dense_item_t{ &storage.items[itemIndex], index });
     }
 
-    auto& resource = resources_[index];
+    auto version = reused ? resource.version.load(std::memory_order_relaxed) : uint32_t{ 1 };
+
+    resource.data = &storage.items[itemIndex];
     resource.size = size;
-    resource.version = version;
     resource.static_index = tag.staticDataIndex;
     resource.dynamic_index = tag.dynamicDataIndex;
     resource.item = itemIndex;
+    resource.version.store(version, std::memory_order_release);
 
     return Resource::Id{ index, version };
 }
 
+// the caller owns the lock of the dynamic storage
 void ResourceManager::resizeDynamicBuffer(Resource::ResourceTag tag, size_t additionalSize)
 {
     assert(tag.dynamicDataIndex < buffers_.size());
-    auto bufferIndex = tag.dynamicDataIndex;
 
-    auto& buffer = buffers_[bufferIndex];
-    auto& ranges = freeRanges_[bufferIndex];
+    auto& storage = buffers_[tag.dynamicDataIndex];
+    auto& buffer = storage.buffer;
 
     auto prevSize = buffer.size();
-    auto newRangeOffset = prevSize;
-    auto addSize = std::max(prevSize, additionalSize);
-    auto newRangeSize = addSize;
-
-    auto mergeIt = std::find_if(ranges.cbegin(), ranges.cend(), [newRangeOffset](auto range) -> bool {
-        return newRangeOffset == (range.first + range.second);
-    });
-
-    if (mergeIt != ranges.cend()) {
-        auto [mergeOffset, mergeSize] = *mergeIt;
-        newRangeOffset = mergeOffset;
-        newRangeSize = newRangeSize + mergeSize;
-        ranges.erase(mergeIt);
-    }
 
-    ranges.insert(std::pair{ static_cast<size_t>(newRangeOffset), static_cast<size_t>(newRangeSize) });
+    // pages are committed in place, the buffer still doubles to keep the number of commits low
+    buffer.resize(prevSize + std::max(std::min(prevSize, buffer.reservedSize() - prevSize), additionalSize));
 
-    buffer.resize(prevSize + addSize, std::byte{ 0 });
+    // merges with the free range at the end
+    storage.freeRanges.free(prevSize, buffer.size() - prevSize);
 }
 
-auto ResourceManager::allocDynamicBuffer(Resource::ResourceTag tag, size_t size, bool resizeAllowed) -> size_t
+auto ResourceManager::allocDynamicBuffer(Resource::ResourceTag tag,
+                                         uint32_t resourceIndex,
+                                         size_t size,
+                                         size_t alignment,
+                                         bool resizeAllowed) -> size_t
 {
     assert(tag.dynamicDataIndex < buffers_.size());
-    auto bufferIndex = tag.dynamicDataIndex;
-
-    auto& ranges = freeRanges_[bufferIndex];
 
-    auto it = std::lower_bound(ranges.cbegin(), ranges.cend(), size, [](auto range, auto value) -> bool {
-        auto [rangeOffset, rangeSize] = range;
-        (void)rangeOffset;
+    auto& storage = buffers_[tag.dynamicDataIndex];
 
-        return rangeSize < value;
-    });
+    std::lock_guard<std::mutex> lock{ storage.mutex };
 
-    if (it == ranges.cend() && resizeAllowed) {
-        resizeDynamicBuffer(tag, size);
+    auto offset = storage.freeRanges.alloc(size, alignment);
 
-        it = std::lower_bound(ranges.cbegin(), ranges.cend(), size, [](auto range, auto value) -> bool {
-            auto [rangeOffset, rangeSize] = range;
-            (void)rangeOffset;
+    if (!offset && resizeAllowed) {
+        resizeDynamicBuffer(tag, size + alignment - 1);
 
-            return rangeSize < value;
-        });
+        offset = storage.freeRanges.alloc(size, alignment);
     }
 
-    if (it == ranges.cend()) {
+    if (!offset) {
         throw std::bad_alloc{};
     }
 
-    auto [allocOffset, allocSize] = *it;
-
-    ranges.erase(it);
-
-    if (allocSize > size) {
-        auto newRangeOffset = allocOffset + size;
-        auto newRangeSize = allocSize - size;
-
-        ranges.insert(std::pair{ static_cast<size_t>(newRangeOffset), static_cast<size_t>(newRangeSize) });
-    }
+    storage.allocations.emplace(*offset, resourceIndex);
 
-    return allocOffset;
+    return *offset;
 }
 
 void ResourceManager::freeDynamicBuffer(uint16_t dynamicIndex, size_t offset, size_t size)
@@ -135,41 +135,14 @@ void ResourceManager::freeDynamicBuffer(uint16_t dynamicIndex, size_t offset, si
     assert(dynamicIndex < buffers_.size());
     assert(size > 0);
 
-    auto freeOffset = offset;
-    auto freeSize = size;
-
-    auto& ranges = freeRanges_[dynamicIndex];
-
-    auto prevRange = std::find_if(ranges.cbegin(), ranges.cend(), [freeOffset](auto&& range) -> bool {
-        auto&& [rangeOffset, rangeSize] = range;
-        return freeOffset == (rangeOffset + rangeSize);
-    });
-
-    if (prevRange != ranges.cend()) {
-        auto [prevOffset, prevSize] = *prevRange;
-        freeOffset = prevOffset;
-        freeSize = freeSize + prevSize;
-
-        ranges.erase(prevRange);
-    }
-
-    auto nextRange = std::find_if(ranges.cbegin(), ranges.cend(), [freeOffset, freeSize](auto&& range) -> bool {
-        auto&& [rangeOffset, rangeSize] = range;
-        return rangeOffset == (freeOffset + freeSize);
-    });
-
-    if (nextRange != ranges.cend()) {
-        auto [nextOffset, nextSize] = *nextRange;
-        (void)nextOffset;
-        freeSize = freeSize + nextSize;
+    auto& storage = buffers_[dynamicIndex];
 
-        ranges.erase(nextRange);
-    }
+    std::lock_guard<std::mutex> lock{ storage.mutex };
 
-    ranges.insert(std::pair{ static_cast<size_t>(freeOffset), static_cast<size_t>(freeSize) });
+    storage.freeRanges.free(offset, size);
+    storage.allocations.erase(offset);
 
-    auto& buffer = buffers_[dynamicIndex];
-    std::fill_n(buffer.data() + offset, size, std::byte{ 0 });
+    std::fill_n(storage.buffer.data() + offset, size, std::byte{ 0 });
 }
 
 void ResourceManager::erase(Resource::Id id)
@@ -177,7 +150,6 @@ void ResourceManager::erase(Resource::Id id)
     auto& resource = get(id);
 
     {
-
         auto const& tag = resource.instance_tag();
 
         if (tag.dynamicDataIndex < buffers_.size() && resource.dynamicDataSize() > 0) {
@@ -190,28 +162,200 @@ void ResourceManager::erase(Resource::Id id)
 
     resource.~Resource();
 
-    auto& [size, version, itemIndex, staticIndex, dynamicIndex] = resources_[id.index()];
+    freeResource(id);
+}
+
+void ResourceManager::freeResource(Resource::Id id)
+{
+    auto& entry = resources_[id.index()];
+    auto& storage = storages_[entry.static_index];
+
+    std::fill_n(entry.data, entry.size, std::byte{ 0 });
+
+    {
+        std::lock_guard<std::mutex> lock{ storage.mutex };
+        storage.freeItems.push_back(entry.item);
+
+        auto& dense = storage.dense;
+        auto last = dense.back();
+
+        resources_[last.resource].dense_index = entry.dense_index;
+        dense[entry.dense_index] = last;
+        dense.pop_back();
+
+        entry.dense_index = std::numeric_limits<uint32_t>::max();
+    }
+
+    entry.data = nullptr;
+    entry.size = 0;
+    entry.item = std::numeric_limits<uint32_t>::max();
+    entry.static_index = std::numeric_limits<uint16_t>::max();
+    entry.dynamic_index = std::numeric_limits<uint16_t>::max();
+
+    // the old id is invalid before its index can be taken again
+    entry.version.fetch_add(1, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock{ resourceMutex_ };
+        freeResourceIndices_.push_back(id.index());
+    }
+}
+
+auto ResourceManager::fragmentation() -> double
+{
+    auto freeSize = size_t{ 0 };
+    auto maxRangeSize = size_t{ 0 };
+
+    for (auto& storage : buffers_) {
+        std::lock_guard<std::mutex> lock{ storage.mutex };
+
+        freeSize += storage.freeRanges.freeSize();
+        maxRangeSize += storage.freeRanges.maxRangeSize();
+    }
+
+    return freeSize > 0 ? 1.0 - static_cast<double>(maxRangeSize) / static_cast<double>(freeSize) : 0.0;
+}
+
+auto ResourceManager::compact(size_t byteBudget) -> compaction_report_t
+{
+    auto report = compaction_report_t{ fragmentation(), 0.0, 0, 0 };
+    auto budgetSpent = false;
+
+    // no load starts meanwhile, the ones in flight write their data, so it is not moved
+    std::lock_guard<std::mutex> loadLock{ loadMutex_ };
+
+    for (auto it = buffers_.begin(); it != buffers_.end() && !budgetSpent; ++it) {
+        auto& storage = *it;
+
+        std::lock_guard<std::mutex> lock{ storage.mutex };
+
+        auto* data = storage.buffer.data();
+        auto cursor = size_t{ 0 };
+
+        // every free range is closed by the allocation which follows it, the data is moved only down,
+        // so one pass over the buffer is enough and a partial pass is picked up by the next call
+        while (auto range = storage.freeRanges.next(cursor)) {
+            auto [rangeOffset, rangeSize] = *range;
+            auto allocation = storage.allocations.find(rangeOffset + rangeSize);
+
+            if (allocation == storage.allocations.end())
+                break;
+
+            auto [offset, resourceIndex] = *allocation;
+            auto& resource = *reinterpret_cast<Resource*>(resources_[resourceIndex].data);
+            auto size = resource.dynamicSize_;
+            auto alignment = resource.dynamicAlignment_;
+            auto newOffset = (rangeOffset + alignment - 1) & ~(alignment - 1);
+
+            assert(resource.dynamicOffset_ == offset);
+
+            if (newOffset >= offset || resource.state_.load(std::memory_order_acquire) == ResourceState::LOADING) {
+                cursor = offset + size;
+                continue;
+            }
+
+            if (report.moved_count > 0 && report.moved_bytes + size > byteBudget) {
+                budgetSpent = true;
+                break;
+            }
+
+            storage.freeRanges.free(offset, size);
+            storage.freeRanges.take(newOffset, size);
 
-    auto& freeItems = freeItems_[staticIndex];
-    auto& storage = storages_[staticIndex];
+            std::memmove(data + newOffset, data + offset, size);
 
-    auto freeOffset = size * itemIndex;
-    auto freeSize = size;
+            // free space stays zeroed, the part of the old place which is not overlapped is cleared
+            auto clearFrom = std::max(newOffset + size, offset);
+            std::fill_n(data + clearFrom, offset + size - clearFrom, std::byte{ 0 });
 
-    std::fill_n(storage.data() + freeOffset, freeSize, std::byte{ 0 });
+            storage.allocations.erase(allocation);
+            storage.allocations.emplace(newOffset, resourceIndex);
 
-    freeItems.push_back(itemIndex);
+            resource.dynamicOffset_ = newOffset;
+            resource.handleDynamicDataRelocation();
 
-    size = 0;
-    version++;
-    itemIndex = std::numeric_limits<uint32_t>::max();
-    staticIndex = std::numeric_limits<uint16_t>::max();
-    dynamicIndex = std::numeric_limits<uint16_t>::max();
+            report.moved_bytes += size;
+            report.moved_count++;
+
+            cursor = newOffset + size;
+        }
+    }
+
+    if (report.moved_count > 0)
+        relocationCount_.fetch_add(1, std::memory_order_release);
+
+    report.fragmentation_after = fragmentation();
+
+    return report;
+}
+
+auto ResourceManager::submitLoad(multithreading::TaskManager& taskManager,
+                                 Resource::Id id,
+                                 std::function<void(Resource&)> load)
+  -> std::optional<multithreading::SharedFuture<void>>
+{
+    using multithreading::TaskPriority;
+
+    auto& resource = get(id);
+
+    // the lock is held till the load is in the list, so the same resource can not be started twice
+    std::lock_guard<std::mutex> lock{ loadMutex_ };
+
+    std::erase_if(loads_, [](auto const& load) -> bool { return load.second.ready(); });
+
+    if (auto it = loads_.find(static_cast<uint64_t>(id)); it != loads_.end())
+        return it->second;
+
+    auto expected = ResourceState::UNLOADED;
+
+    if (!resource.state_.compare_exchange_strong(expected, ResourceState::LOADING, std::memory_order_acq_rel)) {
+        if (expected == ResourceState::LOADED || expected == ResourceState::COMPLETE)
+            return std::nullopt;
+
+        // a handle could not tell when the data is there
+        throw std::runtime_error("resource is loaded or unloaded out of loadAsync");
+    }
+
+    auto dependencies = std::vector<multithreading::SharedFuture<void>>{};
+
+    for (auto const& [loadId, future] : loads_) {
+        if (resource.dependsOn(Resource::Id{ loadId }))
+            dependencies.push_back(future);
+    }
+
+    auto future =
+      taskManager
+        .submitTask(
+          [this, &taskManager, id, dependencies = std::move(dependencies), load = std::move(load)]() -> void {
+              auto& resource = get(id);
+
+              try {
+                  // helps with the other tasks meanwhile, a failed dependency fails the load
+                  for (auto const& dependency : dependencies)
+                      taskManager.waitFor(dependency);
+
+                  load(resource);
+              } catch (...) {
+                  resource.state_.store(ResourceState::UNLOADED, std::memory_order_release);
+                  throw;
+              }
+
+              // the loaders which don't report the state are complete when they return
+              auto loading = ResourceState::LOADING;
+              resource.state_.compare_exchange_strong(loading, ResourceState::COMPLETE, std::memory_order_acq_rel);
+          },
+          TaskPriority::BACKGROUND)
+        .share();
+
+    loads_.emplace(static_cast<uint64_t>(id), future);
+
+    return future;
 }
 
 auto ResourceManager::isValid(Resource::Id id) const -> bool
 {
-    return id.index() < resources_.size() && resources_[id.index()].version == id.version();
+    return id.index() < resourceCount_.load(std::memory_order_acquire) &&
+           resources_[id.index()].version.load(std::memory_order_acquire) == id.version();
 }
 
 auto ResourceManager::isValid(Resource const& resource) const -> bool
@@ -222,8 +366,7 @@ auto ResourceManager::isValid(Resource const& resource) const -> bool
 auto ResourceManager::get(Resource::Id id) const -> Resource const&
 {
     assert(isValid(id));
-    auto const& resource = resources_[id.index()];
-    return *reinterpret_cast<Resource const*>(storages_[resource.static_index].data() + resource.item * resource.size);
+    return *reinterpret_cast<Resource const*>(resources_[id.index()].data);
 }
 
 auto ResourceManager::get(Resource::Id id) -> Resource&
@@ -236,7 +379,7 @@ auto ResourceManager::getDynamicData(Resource::Id id) -> std::byte*
     auto& resource = get(id);
     auto const& tag = resource.instance_tag();
 
-    return buffers_[tag.dynamicDataIndex].data() + resource.dynamicDataOffset();
+    return buffers_[tag.dynamicDataIndex].buffer.data() + resource.dynamicDataOffset();
 }
 
 auto ResourceManager::getDynamicData(Resource::Id id) const -> std::byte const*
@@ -244,21 +387,18 @@ auto ResourceManager::getDynamicData(Resource::Id id) const -> std::byte const*
     auto& resource = get(id);
     auto const& tag = resource.instance_tag();
 
-    return buffers_[tag.dynamicDataIndex].data() + resource.dynamicDataOffset();
+    return buffers_[tag.dynamicDataIndex].buffer.data() + resource.dynamicDataOffset();
 }
 
 ResourceManager::~ResourceManager()
 {
-    if (resources_.empty())
-        return;
-
-    for (auto index = static_cast<int32_t>(resources_.size() - 1); index >= 0; index--) {
-        auto&& r = resources_[index];
+    for (auto index = static_cast<int64_t>(resourceCount_.load(std::memory_order_acquire)) - 1; index >= 0; index--) {
+        auto&& r = resources_[static_cast<size_t>(index)];
 
         if (r.size == 0)
             continue;
 
-        erase(Resource::Id{ static_cast<uint32_t>(index), r.version });
+        erase(Resource::Id{ static_cast<uint32_t>(index), r.version.load(std::memory_order_relaxed) });
     }
 }
 }
\ No newline at end of file
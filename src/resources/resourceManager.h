@@ -5,12 +5,25 @@
 #ifndef CYCLONITE_RESOURCEMANAGER_H
 #define CYCLONITE_RESOURCEMANAGER_H
 
+#include "internal/chunkedArray.h"
+#include "internal/freeRanges.h"
+#include "internal/virtualBuffer.h"
+#include "multithreading/future.h"
 #include "resource.h"
+#include <deque>
+#include <functional>
 #include <limits>
-#include <set>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
+namespace cyclonite::multithreading {
+class TaskManager;
+}
+
 namespace cyclonite::resources {
 template<typename R, size_t N, size_t M>
 struct resource_reg_info_t
@@ -33,25 +46,41 @@ inline constexpr bool is_resource_reg_info_specialization_v =
 template<typename T>
 concept ResourceRegInfoSpecialization = internal::is_resource_reg_info_specialization_v<T, resource_reg_info_t>;
 
+// fragmentation is 1 - (largest free range / free size) summed over the dynamic buffers,
+// 0 when all of the free space is in one range per buffer
+struct compaction_report_t
+{
+    double fragmentation_before;
+    double fragmentation_after;
+    size_t moved_bytes;
+    size_t moved_count;
+};
+
 template<typename T>
 concept ResourceTypeConcept = std::derived_from<T, Resource>;
 
+// create, erase, get and isValid can be called from any thread once the resources are registered,
+// ids are taken from one lock-free table, every type keeps its own items and free lists behind its own lock,
+// resources never move in memory, their dynamic data moves only by compact(),
+// resource lists are not safe to iterate while the type is created or erased
 class ResourceManager
 {
     friend class Resource;
 
+    struct dense_item_t;
+
 public:
-    ResourceManager() noexcept;
+    ResourceManager();
 
     ResourceManager(ResourceManager const&) = delete;
 
-    ResourceManager(ResourceManager&&) = default;
+    ResourceManager(ResourceManager&&) = delete;
 
     ~ResourceManager();
 
     auto operator=(ResourceManager const&) -> ResourceManager& = delete;
 
-    auto operator=(ResourceManager&&) -> ResourceManager& = default;
+    auto operator=(ResourceManager&&) -> ResourceManager& = delete;
 
     template<ResourceTypeConcept R, uint32_t InitialCapacity, size_t InitialDynamicBufferSize>
     void registerDynamicSizeResource();
@@ -89,6 +118,15 @@ public:
     template<ResourceTypeConcept R>
     [[nodiscard]] auto count() const -> size_t;
 
+    // calls resource.load(source...) in the background lane, the state goes from UNLOADED to LOADING and
+    // to COMPLETE when the load is over (or back to UNLOADED if it throws, the handle rethrows then),
+    // the loads in flight of the resources it dependsOn() are waited for first, so they have to be requested first,
+    // a load in flight gives the same handle back, a loaded resource gets no handle (there is nothing to wait for),
+    // a resource loading or unloading outside of loadAsync is an error, the loads must be over before it is erased
+    template<typename... Source>
+    auto loadAsync(multithreading::TaskManager& taskManager, Resource::Id id, Source&&... source)
+      -> std::optional<multithreading::SharedFuture<void>>;
+
     template<bool isConst, ResourceTypeConcept R>
     class ResourceList
     {
@@ -96,6 +134,7 @@ public:
         using resource_manager_t = typename std::conditional_t<isConst, ResourceManager const&, ResourceManager&>;
 
     public:
+        // walks the dense list of the type, so only the resources of the type are touched
         class Iterator
         {
         public:
@@ -107,29 +146,22 @@ public:
 
             auto operator++() -> Iterator&;
 
-            auto operator==(Iterator const& rhs) const -> bool { return resource_index_ == rhs.resource_index_; }
-            auto operator!=(Iterator const& rhs) const -> bool { return resource_index_ != rhs.resource_index_; }
+            auto operator==(Iterator const& rhs) const -> bool { return cursor_ == rhs.cursor_; }
+            auto operator!=(Iterator const& rhs) const -> bool { return cursor_ != rhs.cursor_; }
 
             [[nodiscard]] auto operator*() const -> std::conditional_t<isConst, value_type const&, value_type&>;
 
         private:
             friend class ResourceList<isConst, R>;
 
-            Iterator(resource_manager_t resourceManager, size_t cursor)
-              : resourceManager_{ resourceManager }
+            Iterator(std::vector<dense_item_t> const& items, size_t cursor)
+              : items_{ &items }
               , cursor_{ cursor }
-              , resource_index_{ cursor }
-              , count_{ resourceManager.template count<R>() }
             {
             }
 
-            void next();
-
-            resource_manager_t resourceManager_;
-
+            std::vector<dense_item_t> const* items_;
             size_t cursor_;
-            size_t resource_index_;
-            size_t count_;
         };
 
         [[nodiscard]] auto begin() const -> Iterator;
@@ -147,6 +179,15 @@ public:
         resource_manager_t resourceManager_;
     };
 
+    // slides the dynamic data down into the free ranges in front of it, until the budget of bytes is spent
+    // (the first move is always done), the moved resources are notified by handleDynamicDataRelocation(),
+    // it has to be called at the frame boundary, when no other thread touches the resources or their data,
+    // except for the loads in flight (see loadAsync), the data of a loading resource stays in place
+    auto compact(size_t byteBudget) -> compaction_report_t;
+
+    // grows every time compact() moves something, pointers into dynamic data taken before are stale then
+    [[nodiscard]] auto relocationCount() const -> uint64_t { return relocationCount_.load(std::memory_order_acquire); }
+
     template<ResourceTypeConcept R>
     auto resourceList() -> ResourceList<false, R>;
 
@@ -159,7 +200,14 @@ private:
 
     auto allocResource(Resource::ResourceTag tag, size_t size) -> Resource::Id;
 
-    auto allocDynamicBuffer(Resource::ResourceTag tag, size_t size, bool resizeAllowed = true) -> size_t;
+    // gives the item and the id of the destroyed resource back
+    void freeResource(Resource::Id id);
+
+    auto allocDynamicBuffer(Resource::ResourceTag tag,
+                            uint32_t resourceIndex,
+                            size_t size,
+                            size_t alignment,
+                            bool resizeAllowed = true) -> size_t;
 
     void freeDynamicBuffer(uint16_t dynamicIndex, size_t offset, size_t size);
 
@@ -169,68 +217,109 @@ private:
 
     void resizeDynamicBuffer(Resource::ResourceTag tag, size_t additionalSize);
 
+    [[nodiscard]] auto fragmentation() -> double;
+
+    auto submitLoad(multithreading::TaskManager& taskManager,
+                    Resource::Id id,
+                    std::function<void(Resource&)> load) -> std::optional<multithreading::SharedFuture<void>>;
+
 private:
-    struct free_range_comparator
-    {
-        auto operator()(std::pair<size_t, size_t> const& a, std::pair<size_t, size_t> const& b) const -> bool
-        {
-            return a.second < b.second;
-        }
-    };
+    // the address space of a dynamic buffer, it is only reserved, the memory is committed when the buffer grows
+    static constexpr size_t max_dynamic_buffer_size_v = size_t{ 1 } << 36;
 
-    using resource_storage_t = std::vector<std::byte>;
     using free_items_t = std::vector<uint32_t>;
-    using free_ranges_t = std::set<std::pair<size_t, size_t>, free_range_comparator>;
 
+    // a live resource in the dense list of its type
+    struct dense_item_t
+    {
+        std::byte* data;
+        uint32_t resource;
+    };
+
+    // the version is the only field which is read by the threads that do not own the id,
+    // items never move, so the entry keeps the address of its item
     struct resource_t
     {
         using dynamic_buffer_realloc_func_t = void (*)(void*);
 
         resource_t() noexcept
-          : size{ 0 }
+          : data{ nullptr }
+          , size{ 0 }
           , version{ 0 }
           , item{ std::numeric_limits<uint32_t>::max() }
+          , dense_index{ std::numeric_limits<uint32_t>::max() }
           , static_index{ std::numeric_limits<uint16_t>::max() }
           , dynamic_index{ std::numeric_limits<uint16_t>::max() }
         {
         }
 
-        resource_t(size_t s, uint32_t v, uint32_t i, uint16_t si, uint16_t di) noexcept
-          : size{ s }
-          , version{ v }
-          , item{ i }
-          , static_index{ si }
-          , dynamic_index{ di }
-        {
-        }
-
+        std::byte* data;
         size_t size;
-        uint32_t version;
+        std::atomic<uint32_t> version;
         uint32_t item;
+        uint32_t dense_index; // changed under the lock of the type storage only
         uint16_t static_index;
         uint16_t dynamic_index;
     };
 
-    std::vector<resource_t> resources_;
+    struct static_storage_t
+    {
+        static_storage_t(size_t itemSize, size_t initialCapacity)
+          : mutex{}
+          , items{ initialCapacity, itemSize }
+          , freeItems{}
+          , dense{}
+          , item_size{ itemSize }
+        {
+            freeItems.push_back(0); // first available item
+
+            dense.reserve(initialCapacity);
+        }
+
+        mutable std::mutex mutex;
+        internal::ChunkedArray<std::byte> items;
+        free_items_t freeItems;
+        std::vector<dense_item_t> dense; // erased ones are swapped with the last
+        size_t item_size;
+    };
+
+    struct dynamic_storage_t
+    {
+        dynamic_storage_t(size_t reservedSize, size_t initialSize)
+          : mutex{}
+          , buffer{ reservedSize, initialSize }
+          , freeRanges{}
+          , allocations{}
+        {
+            freeRanges.free(0, buffer.size());
+        }
+
+        std::mutex mutex;
+        internal::VirtualBuffer buffer;
+        internal::FreeRanges freeRanges;
+        std::map<size_t, uint32_t> allocations; // offset -> resource index, to find what follows a free range
+    };
+
+    internal::ChunkedArray<resource_t> resources_;
+    std::atomic<uint32_t> resourceCount_;
     std::vector<uint32_t> freeResourceIndices_;
-    std::vector<resource_storage_t> storages_;
-    std::vector<free_items_t> freeItems_;
-    std::vector<resource_storage_t> buffers_;
-    std::vector<free_ranges_t> freeRanges_;
+    std::mutex resourceMutex_;
+    std::deque<static_storage_t> storages_;
+    std::deque<dynamic_storage_t> buffers_;
+    std::atomic<uint64_t> relocationCount_;
+    std::unordered_map<uint64_t, multithreading::SharedFuture<void>> loads_; // by id, the ready ones are dropped lazily
+    std::mutex loadMutex_;
 };
 
 template<ResourceTypeConcept R, uint32_t InitialCapacity>
 void ResourceManager::registerFixedSizeResource()
 {
+    static_assert(InitialCapacity > 0);
+
     R::type_tag().staticDataIndex = ++Resource::ResourceTag::_lastTagIndex;
     assert(R::type_tag().staticDataIndex == storages_.size());
 
-    auto size = sizeof(R);
-
-    storages_.template emplace_back(size * InitialCapacity, std::byte{ 0 });
-
-    auto& freeItems = freeItems_.template emplace_back();
-    freeItems.push_back(0); // first available item
+    storages_.emplace_back(sizeof(R), InitialCapacity);
 }
 
 template<ResourceTypeConcept R, uint32_t InitialCapacity, size_t InitialDynamicBufferSize>
@@ -239,10 +328,7 @@ void ResourceManager::registerDynamicSizeResource()
     registerFixedSizeResource<R, InitialCapacity>();
 
     R::type_tag().dynamicDataIndex = buffers_.size();
-    buffers_.template emplace_back(InitialDynamicBufferSize, std::byte{ 0 });
-
-    auto& freeRanges = freeRanges_.template emplace_back();
-    freeRanges.insert(std::pair{ size_t{ 0 }, InitialDynamicBufferSize });
+    buffers_.emplace_back(std::max(max_dynamic_buffer_size_v, InitialDynamicBufferSize), InitialDynamicBufferSize);
 }
 
 template<typename R, size_t N, size_t M>
@@ -257,22 +343,15 @@ void ResourceManager::registerResource(resource_reg_info_t<R, N, M>)
 
 void ResourceManager::registerResources(ResourceRegInfoSpecialization auto&&... regInfo)
 {
-    assert(resources_.empty());
+    assert(resourceCount_.load(std::memory_order_relaxed) == 0);
 
     auto initialResCount = []<typename R, size_t N, size_t M>(resource_reg_info_t<R, N, M>) -> size_t { return N; };
     auto expectedResourceCount = (... + initialResCount(regInfo));
 
-    resources_.reserve(expectedResourceCount);
-    freeResourceIndices_.reserve(expectedResourceCount);
+    while (resources_.capacity() < expectedResourceCount)
+        resources_.grow();
 
-    storages_.reserve(sizeof...(regInfo));
-    freeItems_.reserve(sizeof...(regInfo));
-
-    auto counter = []<typename R, size_t N, size_t M>(resource_reg_info_t<R, N, M>) -> uint16_t { return M > 0; };
-    auto bufferCount = (... + counter(regInfo));
-
-    buffers_.reserve(bufferCount);
-    freeRanges_.reserve(bufferCount);
+    freeResourceIndices_.reserve(expectedResourceCount);
 
     (registerResource(std::forward<decltype(regInfo)>(regInfo)), ...);
 }
@@ -282,20 +361,30 @@ auto ResourceManager::create(Args&&... args) -> Resource::Id
 {
     auto id = allocResource(R::type_tag_const(), sizeof(R));
 
-    auto const [size, version, itemIndex, staticIndex, _] = resources_[id.index()];
-    (void)version;
-    (void)_;
+    Resource* resource = nullptr;
 
-    Resource* resource = new (storages_[staticIndex].data() + size * itemIndex) R(std::forward<Args>(args)...);
+    // the id is given back, if the resource can not be constructed or its dynamic data doesn't fit
+    try {
+        resource = new (resources_[id.index()].data) R(std::forward<Args>(args)...);
 
-    resource->id_ = id;
-    resource->resourceManager_ = this;
+        resource->id_ = id;
+        resource->resourceManager_ = this;
 
-    if (resource->dynamicDataSize() > 0) {
-        resource->dynamicOffset_ = allocDynamicBuffer(R::type_tag_const(), resource->dynamicDataSize());
-        resource->handleDynamicDataAllocation();
+        if (resource->dynamicDataSize() > 0) {
+            resource->dynamicOffset_ = allocDynamicBuffer(
+              R::type_tag_const(), id.index(), resource->dynamicDataSize(), resource->dynamicDataAlignment());
+        }
+    } catch (...) {
+        if (resource != nullptr)
+            resource->~Resource();
+
+        freeResource(id);
+        throw;
     }
 
+    if (resource->dynamicDataSize() > 0)
+        resource->handleDynamicDataAllocation();
+
     resource->handlePostAllocation();
 
     return id;
@@ -304,37 +393,26 @@ auto ResourceManager::create(Args&&... args) -> Resource::Id
 template<ResourceTypeConcept R>
 auto ResourceManager::count() const -> size_t
 {
-    auto tag = R::type_tag_const();
-
-    auto& storage = storages_[tag.staticDataIndex];
-    auto& items = freeItems_[tag.staticDataIndex];
+    auto const& storage = storages_[R::type_tag_const().staticDataIndex];
 
-    assert((storage.size() % sizeof(R)) == 0);
-    assert(items.size() > 0);
+    std::lock_guard<std::mutex> lock{ storage.mutex };
 
-    return storage.size() / sizeof(R) - (items.size() - 1);
+    return storage.dense.size();
 }
 
-template<bool isConst, ResourceTypeConcept R>
-void ResourceManager::ResourceList<isConst, R>::Iterator::next()
+template<typename... Source>
+auto ResourceManager::loadAsync(multithreading::TaskManager& taskManager, Resource::Id id, Source&&... source)
+  -> std::optional<multithreading::SharedFuture<void>>
 {
-    auto tag = R::type_tag_const();
-    auto& resources = resourceManager_.resources_;
-    auto size = resources.size();
-
-    if (resource_index_ < count_) {
-        while (cursor_ < size && resources[cursor_].static_index != tag.staticDataIndex) {
-            cursor_++;
-        }
-    }
+    return submitLoad(taskManager, id, [... source = std::forward<Source>(source)](Resource& resource) -> void {
+        resource.load(source...);
+    });
 }
 
 template<bool isConst, ResourceTypeConcept R>
 auto ResourceManager::ResourceList<isConst, R>::Iterator::operator++() -> Iterator&
 {
     cursor_++;
-    next();
-    resource_index_++;
     return *this;
 }
 
@@ -342,29 +420,23 @@ template<bool isConst, ResourceTypeConcept R>
 auto ResourceManager::ResourceList<isConst, R>::Iterator::operator*() const
   -> std::conditional_t<isConst, value_type const&, value_type&>
 {
-    assert(resource_index_ < count_);
-    assert(cursor_ < resourceManager_.resources_.size());
-
-    auto& resource = resourceManager_.resources_[cursor_];
-    auto id = Resource::Id{ static_cast<uint32_t>(cursor_), resource.version };
+    assert(cursor_ < items_->size());
 
-    return resourceManager_.template getAs<R>(id);
+    return reinterpret_cast<Resource*>((*items_)[cursor_].data)->template as<R>();
 }
 
 template<bool isConst, ResourceTypeConcept R>
 auto ResourceManager::ResourceList<isConst, R>::begin() const -> Iterator
 {
-    auto iterator = Iterator{ resourceManager_, 0 };
-
-    iterator.next();
-
-    return iterator;
+    return Iterator{ resourceManager_.storages_[R::type_tag_const().staticDataIndex].dense, 0 };
 }
 
 template<bool isConst, ResourceTypeConcept R>
 auto ResourceManager::ResourceList<isConst, R>::end() const -> Iterator
 {
-    return Iterator{ resourceManager_, resourceManager_.template count<R>() };
+    auto const& dense = resourceManager_.storages_[R::type_tag_const().staticDataIndex].dense;
+
+    return Iterator{ dense, dense.size() };
 }
 
 template<ResourceTypeConcept R>
@@ -180,7 +180,7 @@ void Root::dispose()
         vulkanInstance_.reset();
     };
 
-    taskManager_.submitTask(disposeTask).get();
+    multithreading::Worker::threadWorker().waitFor(taskManager_.submitTask(disposeTask));
 
     taskManager_.stop();
 }
@@ -8,6 +8,8 @@
 #include "animations/animation.h"
 #include "components/animator.h"
 #include "multithreading/taskManager.h"
+#include "profiling/hardwareCounters.h"
+#include "profiling/tracer.h"
 #include "resources/resourceManager.h"
 #include "updateStages.h"
 #include <enttx/enttx.h>
@@ -47,6 +49,9 @@ void AnimationSystem::update(SystemManager& systemManager, EntityManager& entity
     (void)node;
 
     if constexpr (STAGE == metrix::value_cast(UpdateStage::EARLY_UPDATE)) {
+        CYCLONITE_ZONE("AnimationSystem::update<EARLY_UPDATE>");
+        CYCLONITE_COUNTERS("AnimationSystem::update<EARLY_UPDATE>");
+
         for (auto& animation : resourceManager_->template resourceList<animations::Animation>()) {
             if (animation.lastFrameUpdate() != frameNumber)
                 animation.beginUpdate(dt);
@@ -75,6 +80,9 @@ void AnimationSystem::update(SystemManager& systemManager, EntityManager& entity
     }
 
     if constexpr (STAGE == value_cast(UpdateStage::LATE_UPDATE)) {
+        CYCLONITE_ZONE("AnimationSystem::update<LATE_UPDATE>");
+        CYCLONITE_COUNTERS("AnimationSystem::update<LATE_UPDATE>");
+
         // TODO:: skinning (update GPU bones)
     }
 
@@ -6,6 +6,8 @@
 #define CYCLONITE_CAMERASYSTEM_H
 
 #include "../components/camera.h"
+#include "profiling/hardwareCounters.h"
+#include "profiling/tracer.h"
 #include "resources/staging.h"
 #include "transformSystem.h"
 #include "uniformSystem.h"
@@ -67,6 +69,9 @@ void CameraSystem::update(SystemManager& systemManager, EntityManager& entityMan
     ((void)args, ...);
 
     if constexpr (STAGE == metrix::value_cast(UpdateStage::LATE_UPDATE)) {
+        CYCLONITE_ZONE("CameraSystem::update<LATE_UPDATE>");
+        CYCLONITE_COUNTERS("CameraSystem::update<LATE_UPDATE>");
+
         auto [transform, camera] = std::as_const(entityManager)
                                      .template getComponents<components::Transform, components::Camera>(renderCamera());
 
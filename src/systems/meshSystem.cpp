@@ -32,8 +32,7 @@ void MeshSystem::init(Root& root,
     if (multithreading::Render::isInRenderThread()) {
         initTask();
     } else {
-        auto&& future = root.taskManager().submitRenderTask(initTask);
-        future.get();
+        root.taskManager().waitFor(root.taskManager().submitRenderTask(initTask));
     }
 }
 
@@ -212,6 +211,33 @@ void MeshSystem::requestVertexDeviceBufferUpdate()
     verticesUpdateRequired_ = true;
 }
 
+auto MeshSystem::packCommands(std::span<VkDrawIndexedIndirectCommand> commands, VkDrawIndexedIndirectCommand* indirect)
+  -> uint32_t
+{
+    auto commandCount = uint32_t{ 0 };
+    auto firstInstance = uint32_t{ 0 };
+
+    for (auto&& command : commands) {
+        if (command.instanceCount > 0) {
+            auto& packed = indirect[commandCount++];
+
+            packed.indexCount = command.indexCount;
+            packed.instanceCount = command.instanceCount;
+            packed.firstIndex = command.firstIndex;
+            packed.vertexOffset = command.vertexOffset;
+            packed.firstInstance = firstInstance;
+
+            command.firstInstance = firstInstance;
+            firstInstance += command.instanceCount;
+            command.instanceCount = 0;
+        } else {
+            command.firstInstance = std::numeric_limits<uint32_t>::max();
+        }
+    }
+
+    return commandCount;
+}
+
 auto MeshSystem::createGeometry(uint32_t vertexCount, uint32_t indexCount) -> uint64_t
 {
     auto& vertices = resourceManager_->get(vertexBuffer_).template as<resources::Staging>();
@@ -7,6 +7,8 @@
 
 #include "components/mesh.h"
 #include "components/transform.h"
+#include "profiling/hardwareCounters.h"
+#include "profiling/tracer.h"
 #include "resources/resourceManager.h"
 #include "resources/staging.h"
 #include "transformSystem.h"
@@ -18,6 +20,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <metrix/containers.h>
 #include <metrix/enum.h>
+#include <span>
 
 namespace cyclonite {
 class Root;
@@ -68,6 +71,14 @@ public:
 
     void requestVertexDeviceBufferUpdate();
 
+    // moves the commands with instances to the front of the indirect buffer and gives each of them a range of
+    // instances, the instance counts of the commands are reset to be counted again while instances are written
+    static auto packCommands(std::span<VkDrawIndexedIndirectCommand> commands, VkDrawIndexedIndirectCommand* indirect)
+      -> uint32_t;
+
+    // writes the transposed 3x4 part of the world matrix
+    static void packInstance(mat4 const& matrix, instanced_data_t& instance);
+
 private:
     void _init(Root& root,
                size_t swapChainLength,
@@ -108,6 +119,24 @@ private:
     bool verticesUpdateRequired_;
 };
 
+inline void MeshSystem::packInstance(mat4 const& matrix, instanced_data_t& instance)
+{
+    instance.transform1.x = matrix[0].x;
+    instance.transform1.y = matrix[1].x;
+    instance.transform1.z = matrix[2].x;
+    instance.transform1.w = matrix[3].x;
+
+    instance.transform2.x = matrix[0].y;
+    instance.transform2.y = matrix[1].y;
+    instance.transform2.z = matrix[2].y;
+    instance.transform2.w = matrix[3].y;
+
+    instance.transform3.x = matrix[0].z;
+    instance.transform3.y = matrix[1].z;
+    instance.transform3.z = matrix[2].z;
+    instance.transform3.w = matrix[3].z;
+}
+
 template<typename EntityManager, typename Geometries>
 auto MeshSystem::createMesh(EntityManager& entityManager, enttx::Entity entity, Geometries&& geometries)
   -> std::enable_if_t<metrix::is_contiguous_v<Geometries> || std::is_same_v<uint64_t, std::decay_t<Geometries>>,
@@ -138,6 +167,9 @@ template<typename SystemManager, typename EntityManager, size_t STAGE, typename.
 void MeshSystem::update(SystemManager& systemManager, EntityManager& entityManager, Args&&... args)
 {
     if constexpr (STAGE == metrix::value_cast(UpdateStage::EARLY_UPDATE)) {
+        CYCLONITE_ZONE("MeshSystem::update<EARLY_UPDATE>");
+        CYCLONITE_COUNTERS("MeshSystem::update<EARLY_UPDATE>");
+
         {
             auto view = entityManager.template getView<components::Mesh>();
 
@@ -155,31 +187,9 @@ void MeshSystem::update(SystemManager& systemManager, EntityManager& entityManag
 
         {
             auto& commandBuffer = resourceManager_->get(commandBuffer_).template as<resources::Staging>();
-            auto* commands = reinterpret_cast<VkDrawIndexedIndirectCommand*>(commandBuffer.ptr());
-
-            auto commandCount = size_t{ 0 };
-
-            for (auto i = size_t{ 0 }, count = commands_.size(); i < count; i++) {
-                if (commands_[i].instanceCount > 0) {
-                    auto firstInstance = commandCount > 0 ? (*(commands + (commandCount - 1))).firstInstance +
-                                                              (*(commands + (commandCount - 1))).instanceCount
-                                                          : uint32_t{ 0 };
-                    auto&& command = *(commands + commandCount++);
-
-                    command.indexCount = commands_[i].indexCount;
-                    command.instanceCount = commands_[i].instanceCount;
-                    command.firstIndex = commands_[i].firstIndex;
-                    command.vertexOffset = commands_[i].vertexOffset;
-                    command.firstInstance = firstInstance;
-
-                    commands_[i].firstInstance = firstInstance;
-                    commands_[i].instanceCount = 0;
-                } else {
-                    commands_[i].firstInstance = std::numeric_limits<uint32_t>::max();
-                }
-            }
 
-            commandCount_ = commandCount;
+            commandCount_ =
+              packCommands(commands_, reinterpret_cast<VkDrawIndexedIndirectCommand*>(commandBuffer.ptr()));
         }
 
         {
@@ -199,34 +209,25 @@ void MeshSystem::update(SystemManager& systemManager, EntityManager& entityManag
                     if (command.firstInstance == std::numeric_limits<uint32_t>::max())
                         continue;
 
-                    auto instance = instanceData + command.firstInstance + command.instanceCount++;
-
-                    instance->transform1.x = matrix[0].x;
-                    instance->transform1.y = matrix[1].x;
-                    instance->transform1.z = matrix[2].x;
-                    instance->transform1.w = matrix[3].x;
-
-                    instance->transform2.x = matrix[0].y;
-                    instance->transform2.y = matrix[1].y;
-                    instance->transform2.z = matrix[2].y;
-                    instance->transform2.w = matrix[3].y;
-
-                    instance->transform3.x = matrix[0].z;
-                    instance->transform3.y = matrix[1].z;
-                    instance->transform3.z = matrix[2].z;
-                    instance->transform3.w = matrix[3].z;
+                    packInstance(matrix, instanceData[command.firstInstance + command.instanceCount++]);
                 }
             }
         }
     }
 
     if constexpr (STAGE == metrix::value_cast(UpdateStage::LATE_UPDATE)) {
+        CYCLONITE_ZONE("MeshSystem::update<LATE_UPDATE>");
+        CYCLONITE_COUNTERS("MeshSystem::update<LATE_UPDATE>");
+
         for (auto&& command : commands_) {
             command.instanceCount = 0;
         }
     }
 
     if constexpr (STAGE == metrix::value_cast(UpdateStage::TRANSFER_STAGE)) {
+        CYCLONITE_ZONE("MeshSystem::update<TRANSFER_STAGE>");
+        CYCLONITE_COUNTERS("MeshSystem::update<TRANSFER_STAGE>");
+
         auto&& [node, signalCount, frameNumber, dt] = std::forward_as_tuple(std::forward<Args>(args)...);
 
         auto& frame = node.getCurrentFrame();
@@ -261,8 +262,8 @@ void MeshSystem::update(SystemManager& systemManager, EntityManager& entityManag
             transferTask();
         } else {
             assert(multithreading::Worker::isInWorkerThread());
-            auto future = multithreading::Worker::threadWorker().taskManager().submitRenderTask(transferTask);
-            future.get();
+            auto& worker = multithreading::Worker::threadWorker();
+            worker.waitFor(worker.taskManager().submitRenderTask(transferTask));
         }
 
         frame.setIndexBuffer(devicePtr_->graphicsQueue(), gpuIndexBuffer_);
@@ -6,6 +6,8 @@
 #define CYCLONITE_RENDERSYSTEM_H
 
 #include "multithreading/taskManager.h"
+#include "profiling/hardwareCounters.h"
+#include "profiling/tracer.h"
 #include "updateStages.h"
 #include "vulkan/device.h"
 #include <enttx/enttx.h>
@@ -45,6 +47,9 @@ void RenderSystem::update(SystemManager& systemManager, EntityManager& entityMan
     using namespace metrix;
 
     if constexpr (STAGE == metrix::value_cast(UpdateStage::RENDERING)) {
+        CYCLONITE_ZONE("RenderSystem::update<RENDERING>");
+        CYCLONITE_COUNTERS("RenderSystem::update<RENDERING>");
+
         auto&& [node, semaphoreCount, frameNumber, dt] = std::forward_as_tuple(std::forward<Args>(args)...);
 
         (void)semaphoreCount;
@@ -59,8 +64,8 @@ void RenderSystem::update(SystemManager& systemManager, EntityManager& entityMan
             writeCommandsTask();
         } else {
             assert(multithreading::Worker::isInWorkerThread());
-            auto future = multithreading::Worker::threadWorker().taskManager().submitRenderTask(writeCommandsTask);
-            future.get();
+            auto& worker = multithreading::Worker::threadWorker();
+            worker.waitFor(worker.taskManager().submitRenderTask(writeCommandsTask));
         }
     }
 
@@ -6,6 +6,8 @@
 #define CYCLONITE_TRANSFORMSYSTEM_H
 
 #include "../components/transform.h"
+#include "profiling/hardwareCounters.h"
+#include "profiling/tracer.h"
 #include "resources/staging.h"
 #include "updateStages.h"
 #include <enttx/enttx.h>
@@ -50,6 +52,9 @@ void TransformSystem::update(SystemManager& systemManager, EntityManager& entity
     (void)dt;
 
     if constexpr (STAGE == metrix::value_cast(UpdateStage::EARLY_UPDATE)) {
+        CYCLONITE_ZONE("TransformSystem::update<EARLY_UPDATE>");
+        CYCLONITE_COUNTERS("TransformSystem::update<EARLY_UPDATE>");
+
         auto& transforms = entityManager.template getStorage<components::Transform>();
 
         for (auto& transform : transforms) {
@@ -20,8 +20,7 @@ void UniformSystem::init(multithreading::TaskManager& taskManager,
     if (multithreading::Render::isInRenderThread()) {
         initTask();
     } else {
-        auto&& future = taskManager.submitRenderTask(initTask);
-        future.get();
+        taskManager.waitFor(taskManager.submitRenderTask(initTask));
     }
 }
 
@@ -6,6 +6,8 @@
 #define CYCLONITE_UNIFORMSYSTEM_H
 
 #include "../typedefs.h"
+#include "profiling/hardwareCounters.h"
+#include "profiling/tracer.h"
 #include "renderSystem.h"
 #include "resources/staging.h"
 #include "updateStages.h"
@@ -71,6 +73,9 @@ void UniformSystem::update(SystemManager& systemManager, EntityManager& entityMa
     ((void)args, ...);
 
     if constexpr (STAGE == metrix::value_cast(UpdateStage::TRANSFER_STAGE)) {
+        CYCLONITE_ZONE("UniformSystem::update<TRANSFER_STAGE>");
+        CYCLONITE_COUNTERS("UniformSystem::update<TRANSFER_STAGE>");
+
         auto&& [node, signalCount, frameNumber, dt] = std::forward_as_tuple(std::forward<Args>(args)...);
 
         auto& frame = node.getCurrentFrame();
@@ -103,8 +108,8 @@ void UniformSystem::update(SystemManager& systemManager, EntityManager& entityMa
             transferTask();
         } else {
             assert(multithreading::Worker::isInWorkerThread());
-            auto future = multithreading::Worker::threadWorker().taskManager().submitRenderTask(transferTask);
-            future.get();
+            auto& worker = multithreading::Worker::threadWorker();
+            worker.waitFor(worker.taskManager().submitRenderTask(transferTask));
         }
 
         frame.setUniformBuffer(devicePtr_->graphicsQueue(), gpuUniforms_);
@@ -162,9 +162,9 @@ auto CommandPool::releaseCommandBuffers(BufferSet<CommandPool, Container>& comma
         releaseCommandsTask();
     } else {
         assert(multithreading::Worker::isInWorkerThread());
-        auto future = multithreading::Worker::threadWorker().taskManager().submitRenderTask(releaseCommandsTask);
+        auto& worker = multithreading::Worker::threadWorker();
 
-        future.get();
+        worker.waitFor(worker.taskManager().submitRenderTask(releaseCommandsTask));
     }
 }
 }
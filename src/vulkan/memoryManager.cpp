@@ -85,8 +85,7 @@ auto MemoryManager::alloc(VkMemoryRequirements const& memoryRequirements, VkMemo
     if (multithreading::Render::isInRenderThread()) {
         allocatedMemory = allocationTask();
     } else {
-        auto future = taskManager_->submitRenderTask(allocationTask);
-        allocatedMemory = future.get();
+        allocatedMemory = taskManager_->waitFor(taskManager_->submitRenderTask(allocationTask));
     }
 
     return allocatedMemory;
@@ -86,8 +86,7 @@ MemoryPage::~MemoryPage()
     if (multithreading::Render::isInRenderThread()) {
         unmapMemoryTask();
     } else {
-        auto future = taskManager_->submitRenderTask(unmapMemoryTask);
-        future.get();
+        taskManager_->waitFor(taskManager_->submitRenderTask(unmapMemoryTask));
     }
 }
 
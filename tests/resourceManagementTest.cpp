@@ -3,15 +3,38 @@
 //
 
 #include "resourceManagementTests.h"
+#include "../src/resources/buffer.h"
 #include "../src/resources/resourceManager.h"
 #include "../src/buffers/arena.h"
+#include "../src/multithreading/taskManager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include <vector>
 
 class TestResource:
   public cyclonite::resources::Resource
   , public cyclonite::buffers::Arena<TestResource>
 {
 public:
-    TestResource() = default;
+    TestResource()
+      : Arena<TestResource>{ 2048 }
+      , testBuffer_{}
+      , dependency_{}
+    {
+    }
+
+    explicit TestResource(size_t dynamicSize)
+      : Resource{ dynamicSize }
+      , Arena<TestResource>{ 2048 }
+      , testBuffer_{}
+      , dependency_{}
+    {
+    }
 
     ~TestResource() = default;
 
@@ -21,8 +44,22 @@ public:
 
     [[nodiscard]] auto instance_tag() const -> ResourceTag const& override { return tag; }
 
+    auto bytes() -> std::byte* { return dynamicData(); }
+
+    [[nodiscard]] auto state() const -> cyclonite::resources::ResourceState { return state_.load(); }
+
+    void setState(cyclonite::resources::ResourceState state) { state_.store(state); }
+
+    [[nodiscard]] auto dependsOn(Id id) const -> bool override
+    {
+        return static_cast<uint64_t>(id) == static_cast<uint64_t>(dependency_);
+    }
+
+    void dependOn(Id id) { dependency_ = id; }
+
 private:
     std::array<std::byte, 2048> testBuffer_;
+    Id dependency_;
 
 private:
     static cyclonite::resources::Resource::ResourceTag tag;
@@ -34,14 +71,20 @@ public:
 
 cyclonite::resources::Resource::ResourceTag TestResource::tag{};
 
-void ResourceManagementTestFixture::SetUp()
+std::unique_ptr<cyclonite::resources::ResourceManager> ResourceManagementTestFixture::resourceManager_{};
+
+void ResourceManagementTestFixture::SetUpTestSuite()
 {
     resourceManager_ = std::make_unique<cyclonite::resources::ResourceManager>();
-    resourceManager_->template registerResources(cyclonite::resources::resource_reg_info_t<TestResource, 10, 512>{});
+    resourceManager_->template registerResources(
+      cyclonite::resources::resource_reg_info_t<TestResource, 10, 512>{},
+      cyclonite::resources::resource_reg_info_t<cyclonite::resources::Buffer, 2, 0>{});
 }
 
-void ResourceManagementTestFixture::TearDown()
-{}
+void ResourceManagementTestFixture::TearDownTestSuite()
+{
+    resourceManager_.reset();
+}
 
 void resourceManagerTest(cyclonite::resources::ResourceManager& resourceManager) {
     // TODO::
@@ -50,4 +93,355 @@ void resourceManagerTest(cyclonite::resources::ResourceManager& resourceManager)
 TEST_F(ResourceManagementTestFixture, ResourceManagerTest)
 {
     resourceManagerTest(*resourceManager_);
-}
\ No newline at end of file
+}
+
+TEST_F(ResourceManagementTestFixture, ConcurrentCreateGetErase)
+{
+    auto& resourceManager = *resourceManager_;
+
+    auto const threadCount = size_t{ 4 };
+    auto const resourceCount = size_t{ 256 };
+
+    auto first = resourceManager.create<TestResource>();
+    auto const* firstAddress = &resourceManager.get(first);
+
+    auto threads = std::vector<std::thread>{};
+    auto failures = std::atomic<size_t>{ 0 };
+
+    for (auto t = size_t{ 0 }; t < threadCount; t++) {
+        threads.emplace_back([&]() -> void {
+            auto ids = std::vector<cyclonite::resources::Resource::Id>{};
+
+            for (auto round = 0; round < 4; round++) {
+                for (auto i = size_t{ 0 }; i < resourceCount; i++)
+                    ids.push_back(resourceManager.create<TestResource>());
+
+                for (auto id : ids) {
+                    if (!resourceManager.isValid(id) || resourceManager.get(id).id() != id)
+                        failures.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                for (auto id : ids)
+                    resourceManager.erase(id);
+
+                for (auto id : ids) {
+                    if (resourceManager.isValid(id))
+                        failures.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                ids.clear();
+            }
+        });
+    }
+
+    for (auto&& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(failures.load(), 0);
+
+    // the storage has grown many times, but the first resource has not moved
+    EXPECT_EQ(&resourceManager.get(first), firstAddress);
+    EXPECT_EQ(resourceManager.count<TestResource>(), 1);
+
+    resourceManager.erase(first);
+}
+
+TEST_F(ResourceManagementTestFixture, DynamicDataDoesNotMoveWhenBufferGrows)
+{
+    auto& resourceManager = *resourceManager_;
+
+    auto first = resourceManager.create<TestResource>(size_t{ 256 });
+    auto* firstBytes = resourceManager.getAs<TestResource>(first).bytes();
+
+    std::fill_n(firstBytes, 256, std::byte{ 0x5a });
+
+    auto ids = std::vector<cyclonite::resources::Resource::Id>{};
+
+    // much more than the initial 512 bytes
+    for (auto i = 0; i < 64; i++)
+        ids.push_back(resourceManager.create<TestResource>(size_t{ 4096 }));
+
+    EXPECT_EQ(resourceManager.getAs<TestResource>(first).bytes(), firstBytes);
+    EXPECT_TRUE(std::all_of(firstBytes, firstBytes + 256, [](auto b) -> bool { return b == std::byte{ 0x5a }; }));
+
+    for (auto id : ids)
+        resourceManager.erase(id);
+
+    resourceManager.erase(first);
+}
+
+TEST_F(ResourceManagementTestFixture, ResourceListVisitsLiveResourcesOnly)
+{
+    auto& resourceManager = *resourceManager_;
+
+    auto ids = std::vector<cyclonite::resources::Resource::Id>{};
+
+    for (auto i = 0; i < 8; i++)
+        ids.push_back(resourceManager.create<TestResource>());
+
+    // the first, one in the middle and the last one
+    for (auto index : { 7, 3, 0 }) {
+        resourceManager.erase(ids[index]);
+        ids.erase(ids.begin() + index);
+    }
+
+    auto visited = std::vector<cyclonite::resources::Resource::Id>{};
+
+    for (auto& resource : resourceManager.resourceList<TestResource>())
+        visited.push_back(resource.id());
+
+    auto less = [](auto lhs, auto rhs) -> bool { return static_cast<uint64_t>(lhs) < static_cast<uint64_t>(rhs); };
+
+    std::sort(visited.begin(), visited.end(), less);
+    std::sort(ids.begin(), ids.end(), less);
+
+    EXPECT_EQ(visited, ids);
+    EXPECT_EQ(resourceManager.count<TestResource>(), ids.size());
+
+    for (auto id : ids)
+        resourceManager.erase(id);
+
+    EXPECT_EQ(resourceManager.count<TestResource>(), 0);
+}
+
+TEST(FreeRangesTest, AlignedAllocationsAreCoalescedOnFree)
+{
+    auto ranges = cyclonite::resources::internal::FreeRanges{};
+    ranges.free(0, 1024);
+
+    auto a = ranges.alloc(10, 1);
+    auto b = ranges.alloc(64, 64);
+    auto c = ranges.alloc(100, 16);
+
+    ASSERT_TRUE(a && b && c);
+
+    EXPECT_EQ(*a, 0);
+    EXPECT_EQ(*b % 64, 0);
+    EXPECT_EQ(*c % 16, 0);
+
+    // the padding in front of the aligned one is still free
+    EXPECT_EQ(ranges.freeSize(), 1024 - 10 - 64 - 100);
+
+    ranges.free(*b, 64);
+    ranges.free(*a, 10);
+    ranges.free(*c, 100);
+
+    EXPECT_EQ(ranges.count(), 1);
+    EXPECT_EQ(ranges.maxRangeSize(), 1024);
+
+    EXPECT_FALSE(ranges.alloc(1025, 1));
+}
+
+TEST_F(ResourceManagementTestFixture, CompactionMovesDynamicDataIntoHoles)
+{
+    auto& resourceManager = *resourceManager_;
+
+    auto ids = std::vector<cyclonite::resources::Resource::Id>{};
+
+    for (auto i = 0; i < 16; i++) {
+        auto id = resourceManager.create<TestResource>(size_t{ 256 });
+        auto* bytes = resourceManager.getAs<TestResource>(id).bytes();
+
+        std::fill_n(bytes, 256, static_cast<std::byte>(i));
+        ids.push_back(id);
+    }
+
+    auto kept = std::vector<std::pair<cyclonite::resources::Resource::Id, int>>{};
+
+    for (auto i = 0; i < 16; i++) {
+        if (i % 2 == 0) {
+            resourceManager.erase(ids[i]);
+        } else {
+            kept.emplace_back(ids[i], i);
+        }
+    }
+
+    auto relocationCount = resourceManager.relocationCount();
+
+    // the first move is done whatever the budget is
+    auto partial = resourceManager.compact(1);
+
+    EXPECT_EQ(partial.moved_count, 1);
+    EXPECT_EQ(partial.moved_bytes, 256);
+    EXPECT_GT(resourceManager.relocationCount(), relocationCount);
+
+    auto report = resourceManager.compact(std::numeric_limits<size_t>::max());
+
+    EXPECT_GT(report.moved_count, 0);
+    EXPECT_GT(report.fragmentation_before, 0.0);
+    EXPECT_LT(report.fragmentation_after, report.fragmentation_before);
+
+    // nothing is left to move
+    EXPECT_EQ(resourceManager.compact(std::numeric_limits<size_t>::max()).moved_count, 0);
+
+    for (auto [id, value] : kept) {
+        auto* bytes = resourceManager.getAs<TestResource>(id).bytes();
+
+        auto expected = static_cast<std::byte>(value);
+
+        EXPECT_TRUE(std::all_of(bytes, bytes + 256, [expected](auto b) -> bool { return b == expected; }));
+    }
+
+    for (auto [id, value] : kept)
+        resourceManager.erase(id);
+}
+
+TEST_F(ResourceManagementTestFixture, LoadAsyncWaitsForDependencies)
+{
+    using namespace std::chrono_literals;
+    using cyclonite::resources::ResourceState;
+
+    auto& resourceManager = *resourceManager_;
+    auto taskManager = cyclonite::multithreading::TaskManager{ 2 };
+
+    auto first = resourceManager.create<TestResource>();
+    auto second = resourceManager.create<TestResource>();
+
+    resourceManager.getAs<TestResource>(second).dependOn(first);
+
+    auto order = std::vector<cyclonite::resources::Resource::Id>{};
+    auto orderMutex = std::mutex{};
+
+    auto loader = [&order, &orderMutex, first](auto id) {
+        return [&order, &orderMutex, first, id](cyclonite::resources::ResourceManager&) -> void {
+            // the dependency is slow, so the dependent one would be over first without the ordering
+            if (static_cast<uint64_t>(id) == static_cast<uint64_t>(first))
+                std::this_thread::sleep_for(50ms);
+
+            std::lock_guard<std::mutex> lock{ orderMutex };
+            order.push_back(id);
+        };
+    };
+
+    auto run = [&]() -> void {
+        auto firstLoad = resourceManager.loadAsync(taskManager, first, loader(first));
+        auto secondLoad = resourceManager.loadAsync(taskManager, second, loader(second));
+
+        ASSERT_TRUE(firstLoad && secondLoad);
+
+        // the load in flight is not started again
+        auto again = resourceManager.loadAsync(taskManager, first, loader(first));
+
+        ASSERT_TRUE(again);
+
+        taskManager.waitFor(*secondLoad);
+        taskManager.waitFor(*firstLoad);
+        taskManager.waitFor(*again);
+
+        // the loaded one is not loaded again
+        EXPECT_FALSE(resourceManager.loadAsync(taskManager, second, loader(second)));
+
+        // nobody could tell when a load out of loadAsync is over
+        auto third = resourceManager.create<TestResource>();
+        resourceManager.getAs<TestResource>(third).setState(ResourceState::LOADING);
+
+        EXPECT_THROW(resourceManager.loadAsync(taskManager, third, loader(third)), std::runtime_error);
+
+        resourceManager.erase(third);
+    };
+
+    taskManager.start(run).get();
+
+    ASSERT_EQ(order.size(), 2);
+    EXPECT_EQ(static_cast<uint64_t>(order[0]), static_cast<uint64_t>(first));
+    EXPECT_EQ(static_cast<uint64_t>(order[1]), static_cast<uint64_t>(second));
+
+    EXPECT_EQ(resourceManager.getAs<TestResource>(first).state(), ResourceState::COMPLETE);
+    EXPECT_EQ(resourceManager.getAs<TestResource>(second).state(), ResourceState::COMPLETE);
+
+    resourceManager.erase(second);
+    resourceManager.erase(first);
+}
+
+TEST_F(ResourceManagementTestFixture, CompactionKeepsLoadingDataInPlace)
+{
+    auto& resourceManager = *resourceManager_;
+    auto taskManager = cyclonite::multithreading::TaskManager{ 2 };
+
+    auto hole = resourceManager.create<TestResource>(size_t{ 256 });
+    auto loading = resourceManager.create<TestResource>(size_t{ 256 });
+
+    resourceManager.erase(hole);
+
+    auto* before = resourceManager.getAs<TestResource>(loading).bytes();
+
+    auto proceed = std::atomic<bool>{ false };
+
+    auto loader = [&proceed, loading](cyclonite::resources::ResourceManager& rm) -> void {
+        auto* bytes = rm.getAs<TestResource>(loading).bytes();
+
+        // the data is written while the compaction could move it
+        std::fill_n(bytes, 128, std::byte{ 7 });
+        proceed.wait(false, std::memory_order_acquire);
+        std::fill_n(bytes + 128, 128, std::byte{ 7 });
+    };
+
+    auto run = [&]() -> void {
+        auto load = resourceManager.loadAsync(taskManager, loading, loader);
+        ASSERT_TRUE(load);
+
+        resourceManager.compact(std::numeric_limits<size_t>::max());
+        EXPECT_EQ(resourceManager.getAs<TestResource>(loading).bytes(), before);
+
+        proceed.store(true, std::memory_order_release);
+        proceed.notify_all();
+
+        taskManager.waitFor(*load);
+
+        // there is nothing to wait for
+        EXPECT_FALSE(resourceManager.loadAsync(taskManager, loading, loader));
+
+        // into the hole once it is loaded
+        resourceManager.compact(std::numeric_limits<size_t>::max());
+        EXPECT_LT(resourceManager.getAs<TestResource>(loading).bytes(), before);
+    };
+
+    taskManager.start(run).get();
+
+    auto* bytes = resourceManager.getAs<TestResource>(loading).bytes();
+
+    EXPECT_TRUE(std::all_of(bytes, bytes + 256, [](auto b) -> bool { return b == std::byte{ 7 }; }));
+
+    resourceManager.erase(loading);
+}
+
+TEST_F(ResourceManagementTestFixture, MappedBufferReadsTheFile)
+{
+    auto& resourceManager = *resourceManager_;
+
+    auto path = std::filesystem::temp_directory_path() / "cyclonite-mapped-buffer-test.bin";
+    auto bytes = std::vector<char>(4096 + 100);
+
+    for (auto i = size_t{ 0 }; i < bytes.size(); i++)
+        bytes[i] = static_cast<char>(i * 7);
+
+    {
+        std::ofstream file{ path, std::ios::binary };
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    auto whole = resourceManager.create<cyclonite::resources::Buffer>(path);
+    auto part = resourceManager.create<cyclonite::resources::Buffer>(path, size_t{ 100 });
+
+    // the mapped data is read-only
+    auto const& wholeBuffer = std::as_const(resourceManager).getAs<cyclonite::resources::Buffer>(whole);
+    auto const& partBuffer = std::as_const(resourceManager).getAs<cyclonite::resources::Buffer>(part);
+
+    EXPECT_TRUE(wholeBuffer.mapped());
+    EXPECT_EQ(wholeBuffer.size(), bytes.size());
+    EXPECT_EQ(std::memcmp(wholeBuffer.data(), bytes.data(), bytes.size()), 0);
+
+    EXPECT_EQ(partBuffer.size(), 100);
+    EXPECT_EQ(std::memcmp(partBuffer.data(), bytes.data(), 100), 0);
+
+    auto view = partBuffer.view<uint8_t>(10, 10);
+    EXPECT_EQ(*(view.begin() + 3), static_cast<uint8_t>(13 * 7));
+
+    // the file is shorter than the size
+    EXPECT_THROW(resourceManager.create<cyclonite::resources::Buffer>(path, bytes.size() + 1), std::system_error);
+
+    resourceManager.erase(part);
+    resourceManager.erase(whole);
+
+    std::filesystem::remove(path);
+}
@@ -18,12 +18,13 @@ public:
     ResourceManagementTestFixture() = default;
 
 protected:
-    void SetUp() override;
+    // resource tags are global, so the resources can be registered only once per process
+    static void SetUpTestSuite();
 
-    void TearDown() override;
+    static void TearDownTestSuite();
 
 protected:
-    std::unique_ptr<cyclonite::resources::ResourceManager> resourceManager_;
+    static std::unique_ptr<cyclonite::resources::ResourceManager> resourceManager_;
 };
 
 #endif // CYCLONITE_RESOURCEMANAGEMENTTESTS_H
@@ -2,15 +2,942 @@
 // Created by bantdit on 11/4/22.
 //
 
+#include "../src/multithreading/coroutine.h"
+#include "../src/multithreading/frameArena.h"
+#include "../src/multithreading/placementPolicy.h"
+#include "../src/multithreading/taskGraph.h"
 #include "../src/multithreading/taskManager.h"
+#include "../src/profiling/hardwareCounters.h"
+#include "../src/profiling/tracer.h"
 #include "taskManagerTest.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static constexpr auto _testWorkerCount = size_t{ 4 };
 
 void TaskManagerTestFixture::SetUp()
 {
-    taskManager_ = std::make_unique<cyclonite::multithreading::TaskManager>();
+    taskManager_ = std::make_unique<cyclonite::multithreading::TaskManager>(_testWorkerCount);
 }
 
 void TaskManagerTestFixture::TearDown()
 {
-    taskManager_.release();
-}
\ No newline at end of file
+    taskManager_.reset();
+}
+
+TEST_F(TaskManagerTestFixture, IdleWorkersPark)
+{
+    using clock_t = std::chrono::steady_clock;
+
+    auto measure = []() -> std::pair<double, double> {
+        // gives everybody time to park
+        std::this_thread::sleep_for(20ms);
+
+        auto cpuStart = std::clock();
+        auto wallStart = clock_t::now();
+
+        std::this_thread::sleep_for(200ms);
+
+        auto cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        auto wall = std::chrono::duration<double>{ clock_t::now() - wallStart };
+
+        auto const iterationCount = 32;
+        auto latency = std::chrono::duration<double, std::micro>{ 0 };
+
+        for (auto i = 0; i < iterationCount; i++) {
+            std::this_thread::sleep_for(2ms);
+
+            auto submitted = clock_t::now();
+            auto future = cyclonite::multithreading::Worker::threadWorker().submitTask(
+              []() -> clock_t::time_point { return clock_t::now(); });
+
+            latency += future.get() - submitted;
+        }
+
+        return std::make_pair(cpu / wall.count(), latency.count() / iterationCount);
+    };
+
+    auto [idleCpu, wakeUpLatency] = taskManager_->start(measure).get();
+
+    RecordProperty("idle_cpu_percent", std::to_string(idleCpu * 100.0));
+    RecordProperty("wake_up_latency_us", std::to_string(wakeUpLatency));
+
+    EXPECT_LT(idleCpu, 0.5);
+}
+
+TEST_F(TaskManagerTestFixture, TaskPoolGrowsInsteadOfSpinning)
+{
+    auto const taskCount = size_t{ 5000 };
+
+    auto submitAll = [&, taskManager = taskManager_.get()]() -> size_t {
+        auto gate = std::atomic<bool>{ false };
+        auto counter = std::atomic<size_t>{ 0 };
+        auto futures = std::vector<cyclonite::multithreading::Future<void>>{};
+
+        futures.reserve(taskCount);
+
+        for (auto i = size_t{ 0 }; i < taskCount; i++) {
+            futures.emplace_back(cyclonite::multithreading::Worker::threadWorker().submitTask([&]() -> void {
+                while (!gate.load())
+                    std::this_thread::yield();
+
+                counter.fetch_add(1);
+            }));
+        }
+
+        auto highWaterMark = taskManager->taskPoolHighWaterMark();
+
+        gate.store(true);
+
+        for (auto&& future : futures)
+            future.get();
+
+        EXPECT_EQ(counter.load(), taskCount);
+
+        return highWaterMark;
+    };
+
+    auto highWaterMark = taskManager_->start(submitAll).get();
+
+    RecordProperty("task_pool_high_water_mark", std::to_string(highWaterMark));
+
+    EXPECT_GE(highWaterMark, taskCount - _testWorkerCount);
+}
+
+TEST_F(TaskManagerTestFixture, MainThreadHelpsWhileWaiting)
+{
+    auto runOnBusyWorkers = [this]() -> bool {
+        auto& worker = cyclonite::multithreading::Worker::threadWorker();
+        auto gate = std::atomic<bool>{ false };
+        auto started = std::atomic<size_t>{ 0 };
+        auto blockers = std::vector<cyclonite::multithreading::Future<void>>{};
+
+        // keeps every worker thread busy, so only the main thread can run the next task
+        for (auto i = size_t{ 1 }; i < _testWorkerCount; i++) {
+            blockers.emplace_back(worker.submitTask([&]() -> void {
+                started.fetch_add(1);
+
+                while (!gate.load())
+                    std::this_thread::yield();
+            }));
+        }
+
+        while (started.load() < _testWorkerCount - 1)
+            std::this_thread::yield();
+
+        auto mainThreadId = std::this_thread::get_id();
+        auto executedInMainThread =
+          worker.waitFor(worker.submitTask([=]() -> bool { return std::this_thread::get_id() == mainThreadId; }));
+
+        gate.store(true);
+
+        for (auto&& blocker : blockers)
+            blocker.get();
+
+        return executedInMainThread;
+    };
+
+    EXPECT_TRUE(taskManager_->start(runOnBusyWorkers).get());
+}
+
+TEST_F(TaskManagerTestFixture, NestedWaitsDoNotBlockWorkers)
+{
+    // every task waits for its children, blocking waits would run out of threads long before the leaves
+    auto sum = [](auto&& self, uint32_t depth) -> uint64_t {
+        if (depth == 0)
+            return 1;
+
+        auto& worker = cyclonite::multithreading::Worker::threadWorker();
+        auto left = worker.submitTask([&self, depth]() -> uint64_t { return self(self, depth - 1); });
+        auto right = worker.submitTask([&self, depth]() -> uint64_t { return self(self, depth - 1); });
+
+        return worker.waitFor(left) + worker.waitFor(right);
+    };
+
+    auto const depth = uint32_t{ 10 };
+
+    auto leafCount = taskManager_->start([&sum]() -> uint64_t { return sum(sum, depth); }).get();
+
+    EXPECT_EQ(leafCount, uint64_t{ 1 } << depth);
+}
+
+TEST_F(TaskManagerTestFixture, PooledFuturesAndDetachedTasks)
+{
+    auto const taskCount = uint64_t{ 512 };
+
+    auto run = [=]() -> uint64_t {
+        auto& worker = cyclonite::multithreading::Worker::threadWorker();
+
+        auto futures = std::vector<cyclonite::multithreading::Future<uint64_t>>{};
+        futures.reserve(taskCount);
+
+        for (auto i = uint64_t{ 0 }; i < taskCount; i++)
+            futures.emplace_back(worker.submitTask([i]() -> uint64_t { return i; }));
+
+        auto sum = uint64_t{ 0 };
+
+        for (auto&& future : futures)
+            sum += worker.waitFor(future);
+
+        auto detachedSum = std::atomic<uint64_t>{ 0 };
+        auto remaining = std::atomic<uint64_t>{ taskCount };
+        auto done = std::promise<void>{};
+        auto future = done.get_future();
+
+        for (auto i = uint64_t{ 0 }; i < taskCount; i++) {
+            worker.submitDetachedTask([i, &detachedSum, &remaining, &done]() -> void {
+                detachedSum.fetch_add(i, std::memory_order_relaxed);
+
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    done.set_value();
+            });
+        }
+
+        worker.waitFor(future);
+
+        return sum + detachedSum.load();
+    };
+
+    EXPECT_EQ(taskManager_->start(run).get(), taskCount * (taskCount - 1));
+}
+
+TEST_F(TaskManagerTestFixture, ResultsOfAnySizeAndReferences)
+{
+    struct alignas(64) over_aligned_t
+    {
+        uint64_t value;
+    };
+
+    auto shared = uint64_t{ 0 };
+
+    auto run = [&shared]() -> void {
+        auto& worker = cyclonite::multithreading::Worker::threadWorker();
+
+        // does not fit the task storage
+        auto large = worker.submitTask([]() -> std::array<uint64_t, 64> {
+            auto values = std::array<uint64_t, 64>{};
+            std::iota(values.begin(), values.end(), uint64_t{ 1 });
+            return values;
+        });
+
+        auto aligned = worker.submitTask([]() -> over_aligned_t { return over_aligned_t{ 42 }; });
+        auto reference = worker.submitTask([&shared]() -> uint64_t& { return shared; });
+        auto sum = worker.taskManager().parallelReduce(
+          size_t{ 0 },
+          size_t{ 64 },
+          size_t{ 8 },
+          std::array<uint64_t, 16>{},
+          [](size_t first, size_t last) -> std::array<uint64_t, 16> {
+              auto partial = std::array<uint64_t, 16>{};
+              partial[0] = last - first;
+              return partial;
+          },
+          [](std::array<uint64_t, 16> lhs, std::array<uint64_t, 16> rhs) -> std::array<uint64_t, 16> {
+              lhs[0] += rhs[0];
+              return lhs;
+          });
+
+        auto values = worker.waitFor(large);
+
+        EXPECT_EQ(std::accumulate(values.begin(), values.end(), uint64_t{ 0 }), 64 * 65 / 2);
+        EXPECT_EQ(worker.waitFor(aligned).value, 42);
+        EXPECT_EQ(&worker.waitFor(reference), &shared);
+        EXPECT_EQ(sum[0], 64);
+    };
+
+    taskManager_->start(run).get();
+}
+
+TEST_F(TaskManagerTestFixture, ParallelForAndReduce)
+{
+    auto const count = size_t{ 100000 };
+    auto const grain = size_t{ 64 };
+
+    auto run = [&, taskManager = taskManager_.get()]() -> void {
+        auto visits = std::vector<std::atomic<uint32_t>>(count);
+
+        taskManager->parallelFor(size_t{ 0 }, count, grain, [&](size_t first, size_t last) -> void {
+            EXPECT_LE(first, last);
+
+            for (auto i = first; i < last; i++) {
+                visits[i].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // a bit of work to give the others a chance to steal
+            auto spin = std::chrono::steady_clock::now() + 2us;
+            while (std::chrono::steady_clock::now() < spin) {
+            }
+        });
+
+        auto visitedOnce = std::all_of(
+          visits.begin(), visits.end(), [](auto const& v) -> bool { return v.load(std::memory_order_relaxed) == 1; });
+
+        EXPECT_TRUE(visitedOnce);
+
+        // combine is not commutative here, the partial ranges have to meet in order
+        using range_t = std::pair<size_t, size_t>;
+
+        auto range = taskManager->parallelReduce(
+          size_t{ 0 },
+          count,
+          grain,
+          range_t{ 0, 0 },
+          [](size_t first, size_t last) -> range_t { return range_t{ first, last }; },
+          [](range_t lhs, range_t rhs) -> range_t {
+              EXPECT_EQ(lhs.second, rhs.first);
+              return range_t{ lhs.first, rhs.second };
+          });
+
+        EXPECT_EQ(range, (range_t{ 0, count }));
+
+        auto sum = taskManager->parallelReduce(
+          uint32_t{ 0 },
+          uint32_t{ 1000 },
+          uint32_t{ 7 },
+          uint64_t{ 0 },
+          [](uint32_t first, uint32_t last) -> uint64_t {
+              auto s = uint64_t{ 0 };
+
+              for (auto i = first; i < last; i++)
+                  s += i;
+
+              return s;
+          },
+          std::plus<>{});
+
+        EXPECT_EQ(sum, uint64_t{ 999 * 1000 / 2 });
+    };
+
+    taskManager_->start(run).get();
+}
+
+TEST_F(TaskManagerTestFixture, TaskGraphRelaunch)
+{
+    using cyclonite::multithreading::TaskGraph;
+
+    auto run = []() -> void {
+        auto graph = TaskGraph{};
+        auto clock = std::atomic<uint32_t>{ 0 };
+        auto stamps = std::array<uint32_t, 6>{};
+        auto shouldFail = false;
+
+        // a diamond: 0 -> (1, 2, 3) -> 4 -> 5
+        for (auto i = size_t{ 0 }; i < stamps.size(); i++) {
+            graph.addNode([&, i]() -> void {
+                stamps[i] = clock.fetch_add(1, std::memory_order_relaxed);
+
+                if (i == 4 && shouldFail)
+                    throw std::runtime_error("node failed");
+            });
+        }
+
+        for (auto i = TaskGraph::node_id_t{ 1 }; i < 4; i++) {
+            graph.addEdge(0, i);
+            graph.addEdge(i, 4);
+        }
+
+        graph.addEdge(4, 5);
+
+        for (auto frame = 0; frame < 1000; frame++) {
+            clock.store(0, std::memory_order_relaxed);
+            graph.run();
+
+            ASSERT_EQ(clock.load(std::memory_order_relaxed), stamps.size());
+
+            for (auto i = size_t{ 1 }; i < 4; i++) {
+                EXPECT_LT(stamps[0], stamps[i]);
+                EXPECT_LT(stamps[i], stamps[4]);
+            }
+
+            EXPECT_LT(stamps[4], stamps[5]);
+        }
+
+        // the failure comes out of wait, the successors are skipped
+        shouldFail = true;
+        clock.store(0, std::memory_order_relaxed);
+
+        EXPECT_THROW(graph.run(), std::runtime_error);
+        EXPECT_EQ(clock.load(std::memory_order_relaxed), 5);
+
+        shouldFail = false;
+        clock.store(0, std::memory_order_relaxed);
+        graph.run();
+
+        EXPECT_EQ(clock.load(std::memory_order_relaxed), stamps.size());
+    };
+
+    taskManager_->start(run).get();
+}
+
+TEST_F(TaskManagerTestFixture, CoroutinesHopBetweenThreads)
+{
+    using cyclonite::multithreading::Coroutine;
+    using cyclonite::multithreading::Render;
+    using cyclonite::multithreading::Worker;
+
+    static auto renderStep = [](int value) -> Coroutine<int> {
+        co_await cyclonite::multithreading::toRenderThread();
+        EXPECT_TRUE(Render::isInRenderThread());
+
+        auto result = value * 2;
+
+        co_await cyclonite::multithreading::toWorkers();
+        EXPECT_TRUE(Worker::isInWorkerThread());
+
+        co_return result;
+    };
+
+    static auto failingStep = []() -> Coroutine<int> {
+        co_await cyclonite::multithreading::toRenderThread();
+        throw std::runtime_error("step failed");
+    };
+
+    static auto frame = []() -> Coroutine<int> {
+        auto sum = co_await renderStep(1);
+
+        auto a = renderStep(2);
+        auto b = renderStep(3);
+        auto c = renderStep(4);
+
+        co_await cyclonite::multithreading::allOf(a, b, c);
+        sum += a.get() + b.get() + c.get();
+
+        auto d = renderStep(5);
+        auto e = failingStep();
+
+        try {
+            co_await cyclonite::multithreading::allOf(d, e);
+        } catch (std::runtime_error const&) {
+            sum += d.get();
+        }
+
+        co_return sum;
+    };
+
+    auto run = []() -> void {
+        for (auto i = 0; i < 100; i++) {
+            auto coroutine = frame();
+            EXPECT_EQ(Worker::threadWorker().waitFor(coroutine.start()), 2 + 4 + 6 + 8 + 10);
+        }
+    };
+
+    taskManager_->start(run).get();
+}
+
+// the frame graph shape: a sync node, nodes hopping to the render thread and back, a node after all of them
+TEST(TaskGraphTest, CoroutineNodesDoNotBlockWorkers)
+{
+    using cyclonite::multithreading::Coroutine;
+    using cyclonite::multithreading::Render;
+    using cyclonite::multithreading::TaskGraph;
+    using cyclonite::multithreading::TaskManager;
+    using cyclonite::multithreading::TaskPriority;
+
+    auto runFrames = [](size_t workerCount, uint32_t nodeCount) -> void {
+        auto taskManager = TaskManager{ workerCount };
+
+        auto run = [nodeCount]() -> void {
+            auto graph = TaskGraph{ TaskPriority::FRAME_CRITICAL };
+            auto renderSteps = std::atomic<uint32_t>{ 0 };
+            auto finished = std::atomic<uint32_t>{ 0 };
+            auto shouldFail = false;
+
+            auto sync = graph.addNode([]() -> void {});
+            auto last = graph.addNode([&]() -> void {
+                EXPECT_EQ(renderSteps.load(std::memory_order_relaxed), nodeCount);
+                finished.fetch_add(1, std::memory_order_relaxed);
+            });
+
+            for (auto i = uint32_t{ 0 }; i < nodeCount; i++) {
+                auto id = graph.addNode([&, i]() -> Coroutine<> {
+                    co_await cyclonite::multithreading::toRenderThread();
+                    EXPECT_TRUE(Render::isInRenderThread());
+
+                    renderSteps.fetch_add(1, std::memory_order_relaxed);
+
+                    if (i == 0 && shouldFail)
+                        throw std::runtime_error("node failed");
+
+                    co_await cyclonite::multithreading::toWorkers();
+                });
+
+                graph.addEdge(sync, id);
+                graph.addEdge(id, last);
+            }
+
+            for (auto frame = 0; frame < 100; frame++) {
+                renderSteps.store(0, std::memory_order_relaxed);
+                graph.run();
+            }
+
+            EXPECT_EQ(finished.load(std::memory_order_relaxed), 100);
+
+            // a failed coroutine skips the successors
+            shouldFail = true;
+            renderSteps.store(0, std::memory_order_relaxed);
+
+            EXPECT_THROW(graph.run(), std::runtime_error);
+            EXPECT_EQ(finished.load(std::memory_order_relaxed), 100);
+        };
+
+        taskManager.start(run).get();
+    };
+
+    runFrames(1, 1);
+    runFrames(1, 8);
+    runFrames(4, 8);
+    runFrames(8, 16);
+}
+
+TEST(LockFreeQueueTest, BuffersAreReclaimedAndShrink)
+{
+    using queue_t = cyclonite::multithreading::lock_free_spmc_queue_t<uint64_t>;
+
+    auto const initialCapacity = size_t{ 16 };
+    auto const burstSize = uint64_t{ 10000 };
+    auto const burstCount = 8;
+
+    auto queue = queue_t{ initialCapacity };
+    auto stolenSum = std::atomic<uint64_t>{ 0 };
+    auto stop = std::atomic<bool>{ false };
+
+    auto thieves = std::vector<std::thread>{};
+
+    for (auto i = 0; i < 3; i++) {
+        thieves.emplace_back([&]() -> void {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (auto item = queue.steal())
+                    stolenSum.fetch_add(item.value(), std::memory_order_relaxed);
+            }
+        });
+    }
+
+    auto poppedSum = uint64_t{ 0 };
+
+    for (auto burst = 0; burst < burstCount; burst++) {
+        for (auto i = uint64_t{ 1 }; i <= burstSize; i++)
+            queue.emplaceBottom(i);
+
+        // the queue stays empty for a while after the burst
+        for (auto i = uint64_t{ 0 }; i < 2 * burstSize; i++) {
+            if (auto item = queue.popBottom())
+                poppedSum += item.value();
+        }
+    }
+
+    stop.store(true);
+
+    for (auto&& thief : thieves)
+        thief.join();
+
+    EXPECT_EQ(poppedSum + stolenSum.load(), burstCount * (burstSize * (burstSize + 1) / 2));
+    EXPECT_EQ(queue.capacity(), initialCapacity);
+    EXPECT_EQ(queue.retiredBufferCount(), 0);
+}
+
+TEST_F(TaskManagerTestFixture, ExternalThreadsInjectTasks)
+{
+    auto const threadCount = 4;
+    auto const tasksPerThread = uint64_t{ 5000 };
+
+    auto run = [&, taskManager = taskManager_.get()]() -> void {
+        auto detachedSum = std::atomic<uint64_t>{ 0 };
+        auto futureSum = std::atomic<uint64_t>{ 0 };
+        auto submitters = std::vector<std::thread>{};
+
+        for (auto t = 0; t < threadCount; t++) {
+            submitters.emplace_back([&]() -> void {
+                EXPECT_FALSE(cyclonite::multithreading::Worker::isInWorkerThread());
+
+                auto futures = std::vector<cyclonite::multithreading::Future<uint64_t>>{};
+                futures.reserve(tasksPerThread);
+
+                for (auto i = uint64_t{ 1 }; i <= tasksPerThread; i++) {
+                    futures.emplace_back(taskManager->submitTask([i]() -> uint64_t { return i; }));
+                    taskManager->submitDetachedTask(
+                      [i, &detachedSum]() -> void { detachedSum.fetch_add(i, std::memory_order_relaxed); });
+                }
+
+                for (auto&& future : futures)
+                    futureSum.fetch_add(taskManager->waitFor(future), std::memory_order_relaxed);
+            });
+        }
+
+        for (auto&& submitter : submitters)
+            submitter.join();
+
+        auto const expected = threadCount * (tasksPerThread * (tasksPerThread + 1) / 2);
+
+        EXPECT_EQ(futureSum.load(), expected);
+
+        // the last detached tasks could be still in flight
+        auto& worker = cyclonite::multithreading::Worker::threadWorker();
+        while (detachedSum.load() != expected)
+            worker.waitFor(taskManager->submitTask([]() -> void {}));
+    };
+
+    taskManager_->start(run).get();
+}
+
+TEST(TaskPriorityTest, LanesAreDrainedInOrderAndBackgroundIsNotStarved)
+{
+    using cyclonite::multithreading::TaskPriority;
+    using cyclonite::multithreading::Worker;
+
+    // the only worker is the main thread, so the order is deterministic
+    auto taskManager = cyclonite::multithreading::TaskManager{ 1 };
+
+    struct counter_t
+    {
+        std::atomic<int> const* remaining;
+
+        [[nodiscard]] auto ready() const -> bool { return remaining->load() == 0; }
+
+        void get() const {}
+    };
+
+    auto run = []() -> void {
+        auto& worker = Worker::threadWorker();
+        auto const laneSize = 8;
+
+        auto order = std::vector<TaskPriority>{};
+        auto remaining = std::atomic<int>{ laneSize * 3 };
+
+        for (auto priority : { TaskPriority::BACKGROUND, TaskPriority::NORMAL, TaskPriority::FRAME_CRITICAL }) {
+            for (auto i = 0; i < laneSize; i++) {
+                worker.submitDetachedTask(
+                  [&order, &remaining, priority]() -> void {
+                      order.push_back(priority);
+                      remaining--;
+                  },
+                  priority);
+            }
+        }
+
+        worker.waitFor(counter_t{ &remaining });
+
+        ASSERT_EQ(order.size(), laneSize * 3);
+        EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+
+        // an endless stream of frame work does not hold back the background
+        auto const chainLength = 1000;
+        auto chain = 0;
+        auto backgroundDoneAt = chainLength;
+        auto background = std::atomic<int>{ laneSize };
+
+        for (auto i = 0; i < laneSize; i++) {
+            worker.submitDetachedTask(
+              [&]() -> void {
+                  EXPECT_EQ(Worker::currentPriority(), TaskPriority::BACKGROUND);
+
+                  if (--background == 0)
+                      backgroundDoneAt = chain;
+              },
+              TaskPriority::BACKGROUND);
+        }
+
+        auto link = std::function<void()>{};
+        auto remainingLinks = std::atomic<int>{ chainLength };
+
+        link = [&]() -> void {
+            chain++;
+            remainingLinks--;
+
+            // inherits the lane
+            if (chain < chainLength)
+                worker.submitDetachedTask([&link]() -> void { link(); });
+        };
+
+        worker.submitDetachedTask([&link]() -> void { link(); }, TaskPriority::FRAME_CRITICAL);
+
+        worker.waitFor(counter_t{ &remainingLinks });
+        worker.waitFor(counter_t{ &background });
+
+        EXPECT_LT(backgroundDoneAt, chainLength);
+    };
+
+    taskManager.start(run).get();
+}
+
+TEST(PlacementPolicyTest, ThreadsArePlacedOnPhysicalCoresFirst)
+{
+    using cyclonite::multithreading::CpuTopology;
+    using cyclonite::multithreading::LogicalCpu;
+    using cyclonite::multithreading::PlacementPolicy;
+
+    EXPECT_EQ(cyclonite::multithreading::parseCpuList("0-2, 5,7-8\n"), (std::vector<uint32_t>{ 0, 1, 2, 5, 7, 8 }));
+    EXPECT_TRUE(cyclonite::multithreading::parseCpuList("").empty());
+
+    // two packages of two cores with two hardware threads, the siblings are numbered after all of the cores
+    auto cpus = std::vector<LogicalCpu>{};
+
+    for (auto id = uint32_t{ 0 }; id < 8; id++)
+        cpus.push_back(LogicalCpu{ id, id % 4, (id % 4) / 2, 1024, id < 4, true });
+
+    auto topology = CpuTopology{ std::move(cpus) };
+
+    EXPECT_EQ(topology.physicalCoreCount(), 4);
+    EXPECT_EQ(topology.packageCount(), 2);
+    EXPECT_FALSE(topology.hybrid());
+
+    auto unrestricted = PlacementPolicy{}.place(topology, 3);
+
+    EXPECT_TRUE(unrestricted.renderThreadCpus.empty());
+    EXPECT_TRUE(std::all_of(unrestricted.workerCpus.begin(),
+                            unrestricted.workerCpus.end(),
+                            [](std::vector<uint32_t> const& workerCpus) -> bool { return workerCpus.empty(); }));
+
+    auto pinned =
+      PlacementPolicy{}.withPinnedRenderThread().withPinnedWorkers().withoutSmtSiblings().place(topology, 3);
+
+    EXPECT_EQ(pinned.renderThreadCpus, std::vector<uint32_t>{ 0 });
+    EXPECT_EQ(pinned.workerCpus, (std::vector<std::vector<uint32_t>>{ { 1 }, { 2 }, { 3 } }));
+
+    // siblings go after all of the cores
+    auto crowded = PlacementPolicy{}.withPinnedWorkers().place(topology, 6);
+
+    EXPECT_EQ(crowded.workerCpus, (std::vector<std::vector<uint32_t>>{ { 0 }, { 1 }, { 2 }, { 3 }, { 4 }, { 5 } }));
+
+    auto restricted = PlacementPolicy{}.withCpuSet({ 6, 2, 42 }).place(topology, 2);
+
+    EXPECT_EQ(restricted.renderThreadCpus, (std::vector<uint32_t>{ 2, 6 }));
+    EXPECT_EQ(restricted.workerCpus, (std::vector<std::vector<uint32_t>>{ { 2, 6 }, { 2, 6 } }));
+
+    // the machine itself
+    auto machine = CpuTopology::detect();
+
+    EXPECT_FALSE(machine.cpus().empty());
+    EXPECT_GE(machine.physicalCoreCount(), 1);
+    EXPECT_LE(machine.physicalCoreCount(), machine.cpus().size());
+
+    // workers are not pinned, the main thread of the test keeps its affinity
+    auto taskManager = cyclonite::multithreading::TaskManager{ 2,
+                                                               cyclonite::multithreading::IdlePolicy{},
+                                                               PlacementPolicy{}.withPinnedRenderThread() };
+
+    EXPECT_EQ(taskManager.placement().renderThreadCpus.size(), 1);
+    EXPECT_TRUE(taskManager.placement().workerCpus[0].empty());
+    EXPECT_EQ(taskManager.start([]() -> int { return 42; }).get(), 42);
+}
+
+TEST(FrameArenaTest, FramesStopAllocatingAfterWarmUp)
+{
+    auto arena = cyclonite::multithreading::FrameArena{ 256 };
+
+    auto frame = [&arena](size_t count) -> void {
+        auto values = cyclonite::multithreading::frame_vector_t<uint64_t>{ arena };
+
+        for (auto i = size_t{ 0 }; i < count; i++)
+            values.push_back(i);
+
+        auto* aligned = arena.allocate(8, 64);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0);
+    };
+
+    frame(1000);
+    EXPECT_GT(arena.chunkCount(), 1);
+    EXPECT_TRUE(arena.reset());
+
+    // the first reset gets one chunk for the whole frame
+    auto const capacity = arena.capacity();
+    EXPECT_EQ(arena.chunkCount(), 1);
+
+    for (auto i = 0; i < 10; i++) {
+        frame(1000);
+        EXPECT_TRUE(arena.reset());
+    }
+
+    EXPECT_EQ(arena.chunkCount(), 1);
+    EXPECT_EQ(arena.capacity(), capacity);
+    EXPECT_EQ(arena.used(), 0);
+
+    // acquired memory keeps the arena
+    arena.acquire(16, 16);
+    EXPECT_FALSE(arena.reset());
+    arena.release();
+    EXPECT_TRUE(arena.reset());
+}
+
+TEST_F(TaskManagerTestFixture, FrameCriticalTasksUseFrameArenas)
+{
+    using cyclonite::multithreading::TaskPriority;
+    using cyclonite::multithreading::Worker;
+
+    static auto step = [](uint64_t value) -> cyclonite::multithreading::Coroutine<uint64_t> {
+        co_await cyclonite::multithreading::toRenderThread();
+        co_await cyclonite::multithreading::toWorkers();
+        co_return value;
+    };
+
+    auto run = [taskManager = taskManager_.get()]() -> void {
+        auto& worker = Worker::threadWorker();
+
+        EXPECT_EQ(Worker::currentFrameArena(), nullptr);
+
+        for (auto frame = 0; frame < 20; frame++) {
+            taskManager->beginFrame();
+
+            auto& arena = worker.frameArena();
+            EXPECT_EQ(Worker::currentFrameArena(), &arena);
+
+            // does not fit the task
+            auto payload = std::array<uint64_t, 32>{};
+            payload.fill(frame);
+
+            auto sum = std::atomic<uint64_t>{ 0 };
+            auto futures = std::vector<cyclonite::multithreading::Future<void>>{};
+
+            for (auto i = 0; i < 64; i++) {
+                futures.emplace_back(worker.submitTask(
+                  [payload, &sum]() -> void { sum.fetch_add(payload.back(), std::memory_order_relaxed); },
+                  TaskPriority::FRAME_CRITICAL));
+            }
+
+            for (auto&& future : futures)
+                worker.waitFor(future);
+
+            EXPECT_EQ(sum.load(), static_cast<uint64_t>(frame) * 64);
+
+            auto coroutine = step(frame);
+            EXPECT_EQ(worker.waitFor(coroutine.start()), static_cast<uint64_t>(frame));
+        }
+    };
+
+    taskManager_->start(run).get();
+}
+
+TEST_F(TaskManagerTestFixture, MetricsCountTasksAndIdleTime)
+{
+    auto const taskCount = uint64_t{ 1000 };
+    auto const renderTaskCount = uint64_t{ 10 };
+
+    auto run = [&]() -> void {
+        auto& worker = cyclonite::multithreading::Worker::threadWorker();
+        auto futures = std::vector<cyclonite::multithreading::Future<void>>{};
+
+        for (auto i = uint64_t{ 0 }; i < taskCount; i++)
+            futures.emplace_back(worker.submitTask([]() -> void {}));
+
+        for (auto&& future : futures)
+            worker.waitFor(future);
+
+        for (auto i = uint64_t{ 0 }; i < renderTaskCount; i++)
+            worker.waitFor(worker.submitRenderTask([]() -> void {}));
+
+        // everybody else has nothing to do
+        std::this_thread::sleep_for(10ms);
+        worker.waitFor(worker.submitTask([]() -> void {}));
+    };
+
+    taskManager_->start(run).get();
+
+    auto metrics = taskManager_->metrics();
+    auto total = metrics.total();
+
+    EXPECT_EQ(metrics.workers.size(), _testWorkerCount);
+    EXPECT_GE(metrics.render.executedTasks, renderTaskCount);
+    EXPECT_GE(total.executedTasks, taskCount + renderTaskCount + 1);
+
+    // a worker gets every task it executes by a pop or a steal
+    EXPECT_EQ(total.executedTasks - metrics.render.executedTasks,
+              total.localPops + total.injectedPops + total.steals - metrics.render.steals);
+
+    EXPECT_GE(total.maxQueueDepth, 1);
+    EXPECT_GT(total.taskPoolCapacity, 0);
+    EXPECT_GE(total.taskPoolHighWaterMark, total.taskPoolSize);
+    EXPECT_GT(total.idleNanoseconds + total.waitingNanoseconds, 0);
+}
+
+#if defined(CYCLONITE_ENABLE_TRACING)
+TEST_F(TaskManagerTestFixture, TracerExportsZonesAndTaskFlows)
+{
+    using cyclonite::profiling::Tracer;
+
+    auto run = []() -> void {
+        CYCLONITE_ZONE("test frame");
+
+        auto& worker = cyclonite::multithreading::Worker::threadWorker();
+        worker.waitFor(worker.submitTask([]() -> void { CYCLONITE_ZONE("test task"); }));
+    };
+
+    Tracer::start();
+    taskManager_->start(run).get();
+    Tracer::stop();
+
+    {
+        CYCLONITE_ZONE("never recorded");
+    }
+
+    auto stream = std::ostringstream{};
+    Tracer::writeChromeTrace(stream);
+
+    auto trace = stream.str();
+
+    EXPECT_EQ(trace.rfind(R"({"displayTimeUnit":"ns","traceEvents":[)", 0), 0);
+    EXPECT_NE(trace.find(R"("name":"test frame")"), std::string::npos);
+    EXPECT_NE(trace.find(R"("name":"test task")"), std::string::npos);
+    EXPECT_NE(trace.find(R"("args":{"name":"main"})"), std::string::npos);
+    EXPECT_EQ(trace.find("never recorded"), std::string::npos);
+
+    // the submission and the execution of the task are linked
+    EXPECT_NE(trace.find(R"("ph":"s")"), std::string::npos);
+    EXPECT_NE(trace.find(R"("ph":"f")"), std::string::npos);
+}
+#endif
+
+TEST(HardwareCountersTest, ScopesAreAggregatedPerNameAndArg)
+{
+    using cyclonite::profiling::HardwareCounters;
+    using cyclonite::profiling::HardwareCounterScope;
+    using cyclonite::profiling::HardwareEvent;
+
+    auto const iterations = uint64_t{ 100 };
+    auto const data = std::vector<uint64_t>(4096, 1);
+    auto sum = std::atomic<uint64_t>{ 0 };
+
+    auto count = [&](uint64_t arg) -> void {
+        for (auto i = uint64_t{ 0 }; i < iterations; i++) {
+            auto scope = HardwareCounterScope{ "counted", arg };
+            sum.fetch_add(std::accumulate(data.begin(), data.end(), uint64_t{ 0 }), std::memory_order_relaxed);
+        }
+    };
+
+    HardwareCounters::start();
+
+    count(1);
+
+    std::thread{ [&]() -> void {
+        count(1);
+        count(2);
+    } }.join();
+
+    HardwareCounters::stop();
+
+    {
+        auto scope = HardwareCounterScope{ "never counted" };
+    }
+
+    auto samples = HardwareCounters::snapshot();
+
+    ASSERT_EQ(samples.size(), 2);
+    EXPECT_STREQ(samples[0].name, "counted");
+    EXPECT_EQ(samples[0].arg, 1);
+    EXPECT_EQ(samples[0].calls, 2 * iterations);
+    EXPECT_EQ(samples[1].arg, 2);
+    EXPECT_EQ(samples[1].calls, iterations);
+    EXPECT_EQ(sum.load(), 3 * iterations * data.size());
+
+    // perf_event_open is not allowed everywhere (containers, vms without a pmu)
+    if (HardwareCounters::available(HardwareEvent::INSTRUCTIONS)) {
+        EXPECT_GT(samples[0].counts[HardwareEvent::INSTRUCTIONS], samples[1].counts[HardwareEvent::INSTRUCTIONS]);
+    }
+}